@@ -0,0 +1,225 @@
+// Runs the registered scenes without a window, GL context or editor UI, so renderer and scene
+// performance can be measured on machines without a display. Each scene is reset, then updated
+// with a fixed dt and drawn into a PixelRenderer (or BinnedRenderer) for a number of frames;
+// frame times cover Update, Clear, Render and the Pixels() resolve an upload would read. With
+// --dump every n-th frame is written as a binary PPM.
+//
+//   sandbox_headless [--scene name] [--frames n] [--size width height] [--dt seconds]
+//                    [--binned] [--dump directory] [--dump-every n] [--list]
+
+#include "app/scenes/SceneRegistry.h"
+#include "engine/core/Color32.h"
+#include "engine/core/IRenderer.h"
+#include "engine/core/InputState.h"
+#include "engine/core/RenderStats.h"
+#include "engine/render/BinnedRenderer.h"
+#include "engine/render/PixelRenderer.h"
+#include "engine/scene/FrameContext.h"
+#include "engine/scene/SceneManager.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    const char* scene = nullptr;
+    int frames = 300;
+    int width = 960;
+    int height = 540;
+    float dt = 1.0f / 60.0f;
+    bool binned = false;
+    const char* dump = nullptr;
+    int dump_every = 1;
+    bool list = false;
+};
+
+void PrintUsage() {
+    std::fprintf(stderr,
+                 "usage: sandbox_headless [--scene name] [--frames n] [--size width height]\n"
+                 "                        [--dt seconds] [--binned] [--dump directory]\n"
+                 "                        [--dump-every n] [--list]\n");
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const int remaining = argc - i - 1;
+        if (std::strcmp(arg, "--scene") == 0 && remaining >= 1) {
+            options->scene = argv[++i];
+        } else if (std::strcmp(arg, "--frames") == 0 && remaining >= 1) {
+            options->frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--size") == 0 && remaining >= 2) {
+            options->width = std::max(1, std::atoi(argv[++i]));
+            options->height = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--dt") == 0 && remaining >= 1) {
+            options->dt = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--binned") == 0) {
+            options->binned = true;
+        } else if (std::strcmp(arg, "--dump") == 0 && remaining >= 1) {
+            options->dump = argv[++i];
+        } else if (std::strcmp(arg, "--dump-every") == 0 && remaining >= 1) {
+            options->dump_every = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--list") == 0) {
+            options->list = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Scene names become file names: anything but letters and digits turns into '_'.
+std::string FileStem(const char* name) {
+    std::string stem = name;
+    for (char& c : stem) {
+        if (!std::isalnum(static_cast<unsigned char>(c))) {
+            c = '_';
+        }
+    }
+    return stem;
+}
+
+// Writes the RGBA8 image as a binary PPM, dropping alpha.
+bool WritePpm(const std::string& path, const uint8_t* pixels, int width, int height, int pitch) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+    bool ok = true;
+    for (int y = 0; y < height && ok; ++y) {
+        const uint8_t* src = pixels + static_cast<size_t>(y) * static_cast<size_t>(pitch) * 4;
+        for (int x = 0; x < width; ++x) {
+            row[static_cast<size_t>(x) * 3 + 0] = src[x * 4 + 0];
+            row[static_cast<size_t>(x) * 3 + 1] = src[x * 4 + 1];
+            row[static_cast<size_t>(x) * 3 + 2] = src[x * 4 + 2];
+        }
+        ok = std::fwrite(row.data(), 1, row.size(), file) == row.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+struct SceneResult {
+    std::vector<double> frame_ms;
+    RenderStats stats;
+};
+
+// Returns false when a dumped frame could not be written.
+bool RunScene(IScene& scene, IRenderer& renderer, const Options& options, SceneResult* result) {
+    const InputState input;
+    const Color32 clear = Color32::FromBytes(0, 0, 0);
+    const std::string stem = options.dump ? FileStem(scene.Name()) : std::string();
+    scene.Reset();
+    renderer.ResetStats();
+    result->frame_ms.reserve(static_cast<size_t>(options.frames));
+    for (int frame = 0; frame < options.frames; ++frame) {
+        const auto start = std::chrono::steady_clock::now();
+        FrameContext context;
+        context.dt = options.dt;
+        context.input = &input;
+        scene.Update(context);
+        renderer.Clear(clear);
+        scene.Render(renderer);
+        const uint8_t* pixels = renderer.Pixels();
+        const auto end = std::chrono::steady_clock::now();
+        result->frame_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        // The main loop resets once the frame is uploaded; keep renderers seeing the same.
+        renderer.ResetDamage();
+        result->stats += renderer.Stats();
+        renderer.ResetStats();
+
+        if (options.dump && frame % options.dump_every == 0) {
+            char suffix[32] = {};
+            std::snprintf(suffix, sizeof(suffix), "_%05d.ppm", frame);
+            const std::string path = std::string(options.dump) + "/" + stem + suffix;
+            if (!WritePpm(path, pixels, renderer.Width(), renderer.Height(), renderer.Pitch())) {
+                std::fprintf(stderr, "failed to write %s\n", path.c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, &options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    SceneManager scenes;
+    RegisterScenes(scenes);
+    if (options.list) {
+        for (size_t i = 0; i < scenes.SceneCount(); ++i) {
+            std::printf("%s\n", scenes.GetScene(i)->Name());
+        }
+        return 0;
+    }
+
+    std::vector<size_t> selected;
+    for (size_t i = 0; i < scenes.SceneCount(); ++i) {
+        if (!options.scene || std::strcmp(scenes.GetScene(i)->Name(), options.scene) == 0) {
+            selected.push_back(i);
+        }
+    }
+    if (selected.empty()) {
+        std::fprintf(stderr, "no scene named \"%s\"; --list shows them\n", options.scene);
+        return 1;
+    }
+    if (options.dump) {
+        std::error_code error;
+        std::filesystem::create_directories(options.dump, error);
+        if (error) {
+            std::fprintf(stderr, "cannot create %s: %s\n", options.dump, error.message().c_str());
+            return 1;
+        }
+    }
+
+    std::unique_ptr<IRenderer> renderer;
+    if (options.binned) {
+        renderer = std::make_unique<BinnedRenderer>(options.width, options.height);
+    } else {
+        renderer = std::make_unique<PixelRenderer>(options.width, options.height);
+    }
+
+    std::printf("%dx%d, %s, %d frames at dt %.4f s\n\n", options.width, options.height,
+                options.binned ? "BinnedRenderer" : "PixelRenderer", options.frames, options.dt);
+    std::printf("%-18s %10s %10s %10s %10s %14s %12s\n", "scene", "avg ms", "min ms", "p95 ms",
+                "max ms", "pixels/frame", "spans/frame");
+    for (size_t index : selected) {
+        scenes.SetActiveIndex(index);
+        IScene* scene = scenes.ActiveScene();
+        SceneResult result;
+        if (!RunScene(*scene, *renderer, options, &result)) {
+            return 1;
+        }
+        std::vector<double> sorted = result.frame_ms;
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (double ms : sorted) {
+            total += ms;
+        }
+        const double frames = static_cast<double>(sorted.size());
+        const size_t p95 = std::min(sorted.size() - 1, static_cast<size_t>(frames * 0.95));
+        std::printf("%-18s %10.3f %10.3f %10.3f %10.3f %14.0f %12.0f\n", scene->Name(),
+                    total / frames, sorted.front(), sorted[p95], sorted.back(),
+                    result.stats.pixels_written / frames, result.stats.spans_filled / frames);
+    }
+    if (!kRenderStats) {
+        std::printf("\nrenderer counters are compiled out of this build\n");
+    }
+    return 0;
+}
@@ -1,10 +1,14 @@
 #include "app/scenes/SceneRegistry.h"
+#include "engine/core/Color32.h"
 #include "engine/core/Color4f.h"
 #include "engine/core/IRenderer.h"
 #include "engine/core/IWindow.h"
 #include "engine/core/Logger.h"
+#include "engine/core/RenderStats.h"
 #include "engine/platform/glfw/GlfwWindow.h"
+#include "engine/render/BinnedRenderer.h"
 #include "engine/render/PixelRenderer.h"
+#include "engine/render/SupersampledRenderer.h"
 #if defined(SANDBOX_D3D11)
 #include "engine/render/d3d11/D3d11Presenter.h"
 #else
@@ -19,6 +23,7 @@
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <utility>
 
 
 namespace {
@@ -27,6 +32,12 @@ EditorUi g_editor_ui{};
 struct AppState {
     std::unique_ptr<IWindow> window;
     std::unique_ptr<IRenderer> renderer;
+    PixelRenderer* pixel_renderer = nullptr;
+    bool binned = false;
+    int supersample = 1;
+    // What the target last showed, to tell whether the next frame needs a redraw.
+    IScene* drawn_scene = nullptr;
+    Color32 drawn_clear;
 #if defined(SANDBOX_D3D11)
     D3d11Presenter presenter;
 #else
@@ -53,7 +64,7 @@ struct AppState {
         int fb_width = 0;
         int fb_height = 0;
         window->GetFramebufferSize(&fb_width, &fb_height);
-        renderer = std::make_unique<PixelRenderer>(fb_width, fb_height);
+        CreateRenderer(false, 1, fb_width, fb_height);
 
 #if defined(SANDBOX_D3D11)
         if (!presenter.Init(glfw_window)) {
@@ -90,6 +101,27 @@ struct AppState {
         return true;
     }
 
+    // pixel_renderer points at the immediate-mode PixelRenderer when that is the backend, for
+    // the settings only it has; with supersampling it is the renderer drawing the samples.
+    void CreateRenderer(bool use_binned, int factor, int width, int height) {
+        binned = use_binned;
+        supersample = factor;
+        if (binned) {
+            auto tiles = std::make_unique<BinnedRenderer>(width, height);
+            Logger::Info("Tile-binned renderer using " + std::to_string(tiles->ThreadCount()) +
+                         " threads.");
+            pixel_renderer = nullptr;
+            renderer = std::move(tiles);
+        } else {
+            auto pixels = std::make_unique<PixelRenderer>(width, height);
+            pixel_renderer = pixels.get();
+            renderer = std::move(pixels);
+        }
+        if (factor > 1) {
+            renderer = std::make_unique<SupersampledRenderer>(std::move(renderer), factor);
+        }
+    }
+
     bool Frame() {
         if (!initialized) {
             return false;
@@ -109,9 +141,31 @@ struct AppState {
 
         int desired_width = g_editor_ui.ViewportTargetWidth();
         int desired_height = g_editor_ui.ViewportTargetHeight();
+        const bool use_binned = g_editor_ui.UseBinnedRenderer();
+        const int factor = g_editor_ui.SupersampleFactor();
+        if (use_binned != binned || factor != supersample) {
+            CreateRenderer(use_binned, factor, desired_width, desired_height);
+        }
         if (desired_width != renderer->Width() || desired_height != renderer->Height()) {
             renderer->Resize(desired_width, desired_height);
         }
+        FramebufferLayout layout = g_editor_ui.TiledFramebuffer() ? FramebufferLayout::Tiled
+                                                                   : FramebufferLayout::Linear;
+        if (pixel_renderer && pixel_renderer->Layout() != layout) {
+            pixel_renderer->SetLayout(layout);
+        }
+        // The overdraw heatmap is per sample when supersampling, so it is only offered without.
+        const bool overdraw_view = g_editor_ui.OverdrawView() && supersample == 1;
+        if (pixel_renderer) {
+            pixel_renderer->SetOverdrawView(overdraw_view);
+        }
+        // The supersampling resolve reads RGBA8 samples and writes RGBA8 pixels, and the
+        // heatmap is built as RGBA8.
+        const PixelFormat format = supersample > 1 || overdraw_view ? PixelFormat::RGBA8
+                                                                    : g_editor_ui.OutputFormat();
+        if (pixel_renderer && pixel_renderer->Format() != format) {
+            pixel_renderer->SetOutputFormat(format);
+        }
 
         int win_width = 0;
         int win_height = 0;
@@ -128,8 +182,22 @@ struct AppState {
             window->SetVsync(g_editor_ui.VsyncEnabled());
         }
 
-        const float* clear_color = g_editor_ui.ClearColor();
-        renderer->Clear(Color4f{clear_color[0], clear_color[1], clear_color[2], clear_color[3]});
+#if !defined(SANDBOX_D3D11)
+        // Drawing straight into the presenter's mapped buffer leaves Upload nothing to copy.
+        // This runs every frame before drawing, which also attaches a buffer of the new size
+        // after a resize.
+        // Packed output formats are uploaded from the renderer's own packed copy instead.
+        // The samples are not what gets presented when supersampling, nor the drawn pixels
+        // while the overdraw heatmap is shown.
+        if (pixel_renderer) {
+            const bool zero_copy = g_editor_ui.ZeroCopyTarget() && supersample == 1 &&
+                                   !overdraw_view &&
+                                   pixel_renderer->Format() == PixelFormat::RGBA8;
+            pixel_renderer->SetExternalTarget(
+                zero_copy ? presenter.MappedTarget(renderer->Width(), renderer->Height())
+                          : nullptr);
+        }
+#endif
 
         double now = glfwGetTime();
         float dt = static_cast<float>(now - last_time);
@@ -154,15 +222,34 @@ struct AppState {
             update_dt = 1.0f / 60.0f;
         }
 
-        if (IScene* scene = scenes.ActiveScene()) {
-            if (advance || step) {
-                FrameContext context;
-                context.dt = update_dt;
-                context.input = &input;
-                context.viewport_hovered = g_editor_ui.IsViewportHovered();
-                scene->Update(context);
+        IScene* scene = scenes.ActiveScene();
+        if (scene && (advance || step)) {
+            FrameContext context;
+            context.dt = update_dt;
+            context.input = &input;
+            context.viewport_hovered = g_editor_ui.IsViewportHovered();
+            scene->Update(context);
+        }
+
+        // The presenter keeps showing the last uploaded frame, so an unchanged scene over an
+        // unchanged target needs no clear, render or upload. Resizes and setting changes leave
+        // damage on the target, which forces the redraw.
+        const float* clear_color = g_editor_ui.ClearColor();
+        const Color32 clear =
+            Color4f{clear_color[0], clear_color[1], clear_color[2], clear_color[3]};
+        const bool redraw = !renderer->Damage().empty() || scene != drawn_scene ||
+                            clear != drawn_clear || (scene && scene->OutputChanged());
+        if (redraw) {
+            renderer->Clear(clear);
+            if (scene) {
+                scene->Render(*renderer);
+            }
+            drawn_scene = scene;
+            drawn_clear = clear;
+            if (pixel_renderer && pixel_renderer->OverdrawView()) {
+                const OverdrawStats& overdraw = pixel_renderer->Overdraw();
+                g_editor_ui.SetOverdrawStats(overdraw.writes, overdraw.clipped, overdraw.covered);
             }
-            scene->Render(*renderer);
         }
 
         int viewport_mouse_x = 0;
@@ -177,18 +264,24 @@ struct AppState {
         }
         was_left_down = left_down;
 
-        if (has_viewport_mouse) {
-            Color4f cursor_color = left_down ? Color4f::FromBytes(64, 200, 120, 255)
-                                             : Color4f::FromBytes(240, 120, 120, 255);
-
-            for (int dy = -2; dy <= 2; ++dy) {
-                for (int dx = -2; dx <= 2; ++dx) {
-                    renderer->PutPixel(viewport_mouse_x + dx, viewport_mouse_y + dy, cursor_color);
-                }
+        // The cursor is composited over the viewport image by EditorUi, so it keeps following
+        // the mouse on frames that skip the redraw.
+        if (redraw) {
+#if !defined(SANDBOX_D3D11)
+            presenter.SetStreamedUpload(g_editor_ui.StreamedUpload());
+#endif
+            if (presenter.Upload(*renderer)) {
+                renderer->ResetDamage();
             }
+            g_editor_ui.SetUploadStats(presenter.UploadMs(), presenter.UploadBytes());
+        } else {
+            g_editor_ui.SetUploadStats(0.0f, 0);
         }
-
-        presenter.Upload(*renderer);
+        // Read after the upload: the binned renderer only counts its tiles once Pixels() ran.
+        RenderStats frame_stats = renderer->Stats();
+        frame_stats.bytes_uploaded = redraw ? presenter.UploadBytes() : 0;
+        g_editor_ui.AddFrameStats(dt * 1000.0f, frame_stats);
+        renderer->ResetStats();
 
 #if defined(SANDBOX_D3D11)
         presenter.Resize(fb_width, fb_height);
@@ -199,8 +292,9 @@ struct AppState {
 #endif
 
         imgui.BeginFrame();
-        g_editor_ui.Draw(presenter.TextureId(), renderer->Width(), renderer->Height(), win_width,
-                         win_height, scenes);
+        g_editor_ui.Draw(presenter.TextureId(),
+                         ImVec2(presenter.UvExtentX(), presenter.UvExtentY()), renderer->Width(),
+                         renderer->Height(), win_width, win_height, scenes);
         imgui.EndFrame();
 
 #if defined(SANDBOX_D3D11)
@@ -218,6 +312,7 @@ struct AppState {
         }
         imgui.Shutdown();
         presenter.Shutdown();
+        pixel_renderer = nullptr;
         renderer.reset();
         window.reset();
         initialized = false;
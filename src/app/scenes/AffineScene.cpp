@@ -1,5 +1,6 @@
 #include "app/scenes/AffineScene.h"
 
+#include "engine/core/Color32.h"
 #include "trigonometry.h"
 #include "vec2.h"
 #include "vec3.h"
@@ -37,6 +38,24 @@ AffineScene::AffineScene() : flags{false} {
         {0, 1, 0},
         {100, 100, 1},
     };
+
+    BuildImage();
+}
+
+void AffineScene::BuildImage() {
+    constexpr int kSize = 100;
+    constexpr int kCell = 10;
+    std::vector<Color32> pixels(kSize * kSize);
+    for (int y = 0; y < kSize; ++y) {
+        for (int x = 0; x < kSize; ++x) {
+            const bool dark = ((x / kCell) + (y / kCell)) % 2 != 0;
+            const uint8_t shade = static_cast<uint8_t>(dark ? 60 : 230);
+            pixels[y * kSize + x] = Color32::FromBytes(shade, static_cast<uint8_t>(x * 255 / kSize),
+                                                       static_cast<uint8_t>(y * 255 / kSize));
+        }
+    }
+    image_ = Image(kSize, kSize, pixels.data(), kSize,
+                   morton_ ? ImageLayout::Morton : ImageLayout::Linear);
 }
 
 AffineScene::~AffineScene() {}
@@ -52,26 +71,61 @@ void AffineScene::Reset() { time_ = 0.0f; }
 void AffineScene::Render(IRenderer& renderer) {
     int w = renderer.Width();
     int h = renderer.Height();
+    const std::array<bool, 6> state = State();
+    if (!list_.Empty() && state == recorded_state_ && w == list_.Width() &&
+        h == list_.Height()) {
+        list_.Draw(renderer);
+        return;
+    }
+    list_.Reset();
+    list_.Resize(w, h);
+    recorded_state_ = state;
     sgm::vec2 center = {w * 0.5f, h * 0.5f};
 
-    for (const auto& bv : box_) {
-        sgm::mat3 transform_mat{1.0f};
-        if (flags[0])
-            transform_mat = S * transform_mat;
-        if (flags[1])
-            transform_mat = R * transform_mat;
-        if (flags[2])
-            transform_mat = T * transform_mat;
-        sgm::vec3 pos = transform_mat * bv;
-        renderer.PutPixel(pos.x + center.x, pos.y + center.y, {1.0f, 1.0f, 1.0f, 1.0f});
+    sgm::mat3 transform_mat{1.0f};
+    if (flags[0])
+        transform_mat = S * transform_mat;
+    if (flags[1])
+        transform_mat = R * transform_mat;
+    if (flags[2])
+        transform_mat = T * transform_mat;
+
+    if (draw_image_) {
+        // Columns of the matrix are the images of the u and v axes and of the origin.
+        const ImageTransform transform{transform_mat[0][0], transform_mat[1][0],
+                                       transform_mat[2][0] + center.x, transform_mat[0][1],
+                                       transform_mat[1][1], transform_mat[2][1] + center.y};
+        list_.BlitTransformed(image_, transform,
+                              bilinear_ ? ImageFilter::Bilinear : ImageFilter::Nearest);
+        list_.Draw(renderer);
+        return;
     }
+
+    coords_.resize(box_.size());
+    for (size_t i = 0; i < box_.size(); ++i) {
+        sgm::vec3 pos = transform_mat * box_[i];
+        coords_[i].x = static_cast<int>(pos.x + center.x);
+        coords_[i].y = static_cast<int>(pos.y + center.y);
+    }
+    list_.PutPixels(coords_.data(), coords_.size(), Color32::FromBytes(255, 255, 255, 255));
+    list_.Draw(renderer);
 }
 
+bool AffineScene::OutputChanged() const { return list_.Empty() || State() != recorded_state_; }
+
 void AffineScene::DrawSceneGui() {
     ImGui::TextDisabled("No Scene Data.");
     ImGui::Checkbox("Scale", &flags[0]);
     ImGui::Checkbox("Rotate", &flags[1]);
     ImGui::Checkbox("Translation", &flags[2]);
+    ImGui::Separator();
+    ImGui::Checkbox("Draw as Image", &draw_image_);
+    if (draw_image_) {
+        ImGui::Checkbox("Bilinear", &bilinear_);
+        if (ImGui::Checkbox("Morton Layout", &morton_)) {
+            BuildImage();
+        }
+    }
 }
 
 void AffineScene::DrawInspectorGui() { ImGui::TextDisabled("No Inspector Data."); }
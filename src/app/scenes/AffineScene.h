@@ -1,10 +1,14 @@
 #pragma once
 
+#include "engine/core/Image.h"
+#include "engine/core/PixelCoord.h"
+#include "engine/render/DisplayList.h"
 #include "engine/scene/IScene.h"
 #include "mat3.h"
 #include "vec3.h"
 
 #include <array>
+#include <vector>
 
 class AffineScene : public IScene {
   public:
@@ -19,15 +23,31 @@ class AffineScene : public IScene {
     void Reset() override;
     void Update(const FrameContext& context) override;
     void Render(IRenderer& renderer) override;
+    bool OutputChanged() const override;
     void DrawSceneGui() override;
     void DrawInspectorGui() override;
 
   private:
+    void BuildImage();
+    std::array<bool, 6> State() const {
+        return {flags[0], flags[1], flags[2], draw_image_, bilinear_, morton_};
+    }
+
     float time_ = 0.0f;
 
     std::vector<sgm::vec3> box_;
+    std::vector<PixelCoord> coords_;
     sgm::mat3 S;
     sgm::mat3 R;
     sgm::mat3 T;
     std::array<bool, 3> flags;
+    // Draws the box as one transformed blit of a checker image instead of as points.
+    bool draw_image_ = false;
+    bool bilinear_ = true;
+    bool morton_ = false;
+    Image image_;
+
+    // The box, re-recorded only when a checkbox or the target size changes.
+    DisplayList list_;
+    std::array<bool, 6> recorded_state_{};
 };
@@ -1,30 +1,9 @@
 #include "app/scenes/CircleScene.h"
 
-#include "engine/core/Logger.h"
-
 #include <GLFW/glfw3.h>
-#include <cmath>
-#include <cstdlib>
 #include <imgui.h>
-#include <string>
-
-void CircleScene::Update(const FrameContext& context) {
-    time_ += context.dt;
 
-    if (std::abs(prevRadius_ - radius_) >= 1e-8) {
-        Logger::Info("Change radius : " + std::to_string(prevRadius_));
-        circle_.clear();
-        for (float x = -radius_; x <= radius_; ++x) {
-            for (float y = -radius_; y <= radius_; ++y) {
-                if (x * x + y * y <= radius_ * radius_) {
-                    circle_.push_back(sgm::vec2{x, y});
-                }
-            }
-        }
-    }
-
-    prevRadius_ = radius_;
-}
+void CircleScene::Update(const FrameContext& context) { time_ += context.dt; }
 
 void CircleScene::Reset() { time_ = 0.0f; }
 
@@ -36,14 +15,19 @@ void CircleScene::Render(IRenderer& renderer) {
     }
     sgm::vec2 center{w * 0.5f, h * 0.5f};
 
-    for (const auto& v : circle_) {
-        renderer.PutPixel(center.x + v.x, center.y + v.y, color_);
+    if (thickness_ > 0.0f && thickness_ < radius_) {
+        renderer.StrokeRing(center.x, center.y, radius_ - thickness_, radius_, color_,
+                            BlendMode::SourceOver);
+    } else {
+        renderer.FillCircle(center.x, center.y, radius_, color_, BlendMode::SourceOver);
     }
+    dirty_ = false;
 }
 
 void CircleScene::DrawSceneGui() { ImGui::TextDisabled("No Scene Data."); }
 
 void CircleScene::DrawInspectorGui() {
-    ImGui::SliderFloat("Radius", &radius_, 0.0f, 255.0f);
-    ImGui::ColorEdit4("Color", &color_.r);
+    dirty_ |= ImGui::SliderFloat("Radius", &radius_, 0.0f, 255.0f);
+    dirty_ |= ImGui::SliderFloat("Ring Thickness", &thickness_, 0.0f, 255.0f);
+    dirty_ |= ImGui::ColorEdit4("Color", &color_.r);
 }
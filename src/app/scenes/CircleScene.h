@@ -4,14 +4,13 @@
 #include "engine/math/sgm/public/sgm.h"
 #include "engine/scene/IScene.h"
 
-#include <vector>
-
 class CircleScene : public IScene {
   public:
     const char* Name() const override { return "CircleScene"; }
     void Reset() override;
     void Update(const FrameContext& context) override;
     void Render(IRenderer& renderer) override;
+    bool OutputChanged() const override { return dirty_; }
     void DrawSceneGui() override;
     void DrawInspectorGui() override;
 
@@ -19,9 +18,10 @@ class CircleScene : public IScene {
     float time_ = 0.0f;
 
     float radius_ = 50.0f;
-    float prevRadius_ = 0.0f;
-
-    std::vector<sgm::vec2> circle_;
+    // Zero fills the disc.
+    float thickness_ = 0.0f;
 
     Color4f color_{1.0f, 0.0f, 0.0f, 1.0f};
+    // Set by the inspector when the circle changes; cleared by Render.
+    bool dirty_ = true;
 };
@@ -1,42 +1,45 @@
 #include "app/scenes/DotProductScene.h"
 
+#include "engine/core/Color32.h"
 #include "engine/core/Color4f.h"
+#include "engine/render/PixelKernels.h"
 
 #include <algorithm>
 #include <cmath>
 #include <imgui.h>
+#include <vector>
 
 namespace {
-inline void DrawFilledCircle(IRenderer& renderer, const sgm::vec2& center, int radius,
-                             const Color4f& color) {
-    int r2 = radius * radius;
-    int cx = static_cast<int>(center.x);
-    int cy = static_cast<int>(center.y);
-    for (int y = -radius; y <= radius; ++y) {
-        int y2 = y * y;
-        for (int x = -radius; x <= radius; ++x) {
-            if (x * x + y2 <= r2) {
-                renderer.PutPixel(cx + x, cy + y, color);
-            }
-        }
+inline int SpanHalfWidth(int r2, int y2) {
+    int remaining = r2 - y2;
+    int half = static_cast<int>(std::sqrt(static_cast<float>(remaining)));
+    while (half > 0 && half * half > remaining) {
+        --half;
+    }
+    while ((half + 1) * (half + 1) <= remaining) {
+        ++half;
     }
+    return half;
 }
 
-inline void DrawLambertSphere(IRenderer& renderer, const sgm::vec2& center, float radius,
+// Shades each row in float and converts it to packed pixels in one pass, so the clamp, scale
+// and optional sRGB encode run as a vector kernel instead of once per pixel.
+inline void DrawLambertSphere(IRenderer& renderer, std::vector<Color4f>& shaded,
+                              std::vector<Color32>& row, const sgm::vec2& center, float radius,
                               const sgm::vec3& light_pos, const Color4f& base_color,
                               const Color4f& ambient_color, float ambient,
-                              const Color4f& diffuse_color, float diffuse) {
+                              const Color4f& diffuse_color, float diffuse,
+                              TransferFunction transfer) {
     int r = static_cast<int>(radius);
     int r2 = r * r;
     int cx = static_cast<int>(center.x);
     int cy = static_cast<int>(center.y);
+    shaded.resize(static_cast<size_t>(2 * r + 1));
+    row.resize(shaded.size());
     for (int y = -r; y <= r; ++y) {
         int y2 = y * y;
-        for (int x = -r; x <= r; ++x) {
-            int x2 = x * x;
-            if (x2 + y2 > r2) {
-                continue;
-            }
+        int half = SpanHalfWidth(r2, y2);
+        for (int x = -half; x <= half; ++x) {
             float nx = static_cast<float>(x) / radius;
             float ny = static_cast<float>(y) / radius;
             float nz = std::sqrt(std::max(0.0f, 1.0f - nx * nx - ny * ny));
@@ -53,10 +56,11 @@ inline void DrawLambertSphere(IRenderer& renderer, const sgm::vec2& center, floa
                 base_color.g * (ambient_color.g * ambient_term + diffuse_color.g * diffuse_term);
             float b =
                 base_color.b * (ambient_color.b * ambient_term + diffuse_color.b * diffuse_term);
-            Color4f shaded{std::clamp(r, 0.0f, 1.0f), std::clamp(g, 0.0f, 1.0f),
-                           std::clamp(b, 0.0f, 1.0f), 1.0f};
-            renderer.PutPixel(cx + x, cy + y, shaded);
+            shaded[static_cast<size_t>(x + half)] = Color4f{r, g, b, 1.0f};
         }
+        const size_t count = static_cast<size_t>(2 * half + 1);
+        ConvertColors(shaded.data(), row.data(), count, transfer);
+        renderer.PutSpan(cx - half, cy + y, row.data(), count);
     }
 }
 } // namespace
@@ -93,17 +97,19 @@ void DotProductScene::Render(IRenderer& renderer) {
     sgm::vec2 light_xy = sphere_center_ + sgm::vec2{std::cos(angle), std::sin(angle)} * orbit;
     float light_z = radius * light_height_scale_;
 
-    DrawLambertSphere(renderer, sphere_center_, radius, sgm::vec3{light_xy.x, light_xy.y, light_z},
-                      sphere_color_, ambient_color_, ambient_intensity_, diffuse_color_,
-                      diffuse_intensity_);
+    DrawLambertSphere(renderer, shaded_, row_, sphere_center_, radius,
+                      sgm::vec3{light_xy.x, light_xy.y, light_z}, sphere_color_, ambient_color_,
+                      ambient_intensity_, diffuse_color_, diffuse_intensity_,
+                      srgb_encode_ ? TransferFunction::Srgb : TransferFunction::Linear);
 
-    DrawFilledCircle(renderer, light_xy, 6, light_color_);
+    renderer.FillCircle(light_xy.x, light_xy.y, 6.0f, light_color_);
 }
 
 void DotProductScene::DrawSceneGui() {
     ImGui::Text("Lambert Lighting");
     ImGui::SliderFloat("Ambient", &ambient_intensity_, 0.0f, 1.0f);
     ImGui::SliderFloat("Diffuse", &diffuse_intensity_, 0.0f, 1.0f);
+    ImGui::Checkbox("sRGB Encode", &srgb_encode_);
     ImGui::ColorEdit4("Sphere Color", &sphere_color_.r);
     ImGui::ColorEdit4("Light Color", &light_color_.r);
     ImGui::ColorEdit4("Ambient Color", &ambient_color_.r);
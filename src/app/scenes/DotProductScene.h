@@ -1,9 +1,12 @@
 #pragma once
 
+#include "engine/core/Color32.h"
 #include "engine/core/Color4f.h"
 #include "engine/math/sgm/public/sgm.h"
 #include "engine/scene/IScene.h"
 
+#include <vector>
+
 class DotProductScene : public IScene {
   public:
     DotProductScene();
@@ -35,4 +38,8 @@ class DotProductScene : public IScene {
     float light_orbit_scale_ = 0.32f;
     float light_height_scale_ = 1.2f;
     float light_speed_ = 0.6f;
+    // Shading is done in linear light; encoding to sRGB on output brightens the falloff.
+    bool srgb_encode_ = false;
+    std::vector<Color4f> shaded_;
+    std::vector<Color32> row_;
 };
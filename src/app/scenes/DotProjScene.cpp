@@ -1,6 +1,6 @@
 #include "app/scenes/DotProjScene.h"
 
-#include "engine/core/Color4f.h"
+#include "engine/core/Color32.h"
 #include "engine/math/sgm/public/sgm.h"
 
 #include <GLFW/glfw3.h>
@@ -8,49 +8,6 @@
 #include <cmath>
 #include <imgui.h>
 
-namespace {
-void DrawLine(IRenderer& renderer, int x0, int y0, int x1, int y1, const Color4f& color) {
-    int dx = std::abs(x1 - x0);
-    int dy = std::abs(y1 - y0);
-    int sx = (x0 < x1) ? 1 : -1;
-    int sy = (y0 < y1) ? 1 : -1;
-    int err = dx - dy;
-
-    int x = x0;
-    int y = y0;
-    while (true) {
-        renderer.PutPixel(x, y, color);
-        if (x == x1 && y == y1) {
-            break;
-        }
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            y += sy;
-        }
-    }
-}
-
-void DrawFilledCircle(IRenderer& renderer, const sgm::vec2& center, int radius,
-                      const Color4f& color) {
-    int r2 = radius * radius;
-    int cx = static_cast<int>(center.x);
-    int cy = static_cast<int>(center.y);
-    for (int y = -radius; y <= radius; ++y) {
-        int y2 = y * y;
-        for (int x = -radius; x <= radius; ++x) {
-            if (x * x + y2 <= r2) {
-                renderer.PutPixel(cx + x, cy + y, color);
-            }
-        }
-    }
-}
-} // namespace
-
 DotProjScene::DotProjScene() {}
 
 DotProjScene::~DotProjScene() {}
@@ -100,24 +57,22 @@ void DotProjScene::Render(IRenderer& renderer) {
     last_proj_t_ = clamped_t;
     last_distance_ = sgm::length(point - proj);
 
-    Color4f axis = Color4f::FromBytes(60, 70, 90, 255);
-    Color4f line_color = Color4f::FromBytes(230, 230, 230, 255);
-    Color4f point_color = Color4f::FromBytes(255, 120, 90, 255);
-    Color4f proj_color = Color4f::FromBytes(255, 210, 90, 255);
-    Color4f dist_color = Color4f::FromBytes(80, 220, 170, 255);
+    constexpr Color32 axis = Color32::FromBytes(60, 70, 90, 255);
+    constexpr Color32 line_color = Color32::FromBytes(230, 230, 230, 255);
+    constexpr Color32 point_color = Color32::FromBytes(255, 120, 90, 255);
+    constexpr Color32 proj_color = Color32::FromBytes(255, 210, 90, 255);
+    constexpr Color32 dist_color = Color32::FromBytes(80, 220, 170, 255);
 
-    DrawLine(renderer, 0, static_cast<int>(center.y), w - 1, static_cast<int>(center.y), axis);
-    DrawLine(renderer, static_cast<int>(center.x), 0, static_cast<int>(center.x), h - 1, axis);
+    renderer.DrawLine({0.0f, center.y, static_cast<float>(w - 1), center.y}, axis);
+    renderer.DrawLine({center.x, 0.0f, center.x, static_cast<float>(h - 1)}, axis);
 
-    DrawLine(renderer, static_cast<int>(line_a.x), static_cast<int>(line_a.y),
-             static_cast<int>(line_b.x), static_cast<int>(line_b.y), line_color);
-    DrawLine(renderer, static_cast<int>(point.x), static_cast<int>(point.y),
-             static_cast<int>(proj.x), static_cast<int>(proj.y), dist_color);
+    renderer.DrawLine({line_a.x, line_a.y, line_b.x, line_b.y}, line_color);
+    renderer.DrawLine({point.x, point.y, proj.x, proj.y}, dist_color);
 
-    DrawFilledCircle(renderer, line_a, 4, line_color);
-    DrawFilledCircle(renderer, line_b, 4, line_color);
-    DrawFilledCircle(renderer, point, 5, point_color);
-    DrawFilledCircle(renderer, proj, 4, proj_color);
+    renderer.FillCircle(line_a.x, line_a.y, 4.0f, line_color);
+    renderer.FillCircle(line_b.x, line_b.y, 4.0f, line_color);
+    renderer.FillCircle(point.x, point.y, 5.0f, point_color);
+    renderer.FillCircle(proj.x, proj.y, 4.0f, proj_color);
 }
 
 void DotProjScene::DrawSceneGui() {
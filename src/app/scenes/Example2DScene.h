@@ -8,7 +8,10 @@ class Example2DScene : public IScene {
     void Reset() override;
     void Update(const FrameContext& context) override;
     void Render(IRenderer& renderer) override;
+    bool OutputChanged() const override { return dirty_; }
 
   private:
     float time_ = 0.0f;
+    // Set when time advances; cleared by Render.
+    bool dirty_ = true;
 };
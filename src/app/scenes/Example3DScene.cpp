@@ -1,6 +1,6 @@
 #include "app/scenes/Example3DScene.h"
 
-#include "engine/core/Color4f.h"
+#include "engine/core/Color32.h"
 #include "engine/math/sgm/public/sgm.h"
 
 #include <GLFW/glfw3.h>
@@ -23,35 +23,25 @@ sgm::vec3 RotateYawPitchRoll(const sgm::vec3& v, float yaw, float pitch, float r
     return vr;
 }
 
-void DrawLine(IRenderer& renderer, int x0, int y0, int x1, int y1, const Color4f& color) {
-    int dx = std::abs(x1 - x0);
-    int dy = std::abs(y1 - y0);
-    int sx = (x0 < x1) ? 1 : -1;
-    int sy = (y0 < y1) ? 1 : -1;
-    int err = dx - dy;
-
-    int x = x0;
-    int y = y0;
-    while (true) {
-        renderer.PutPixel(x, y, color);
-        if (x == x1 && y == y1) {
-            break;
-        }
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            y += sy;
-        }
-    }
-}
+struct Face {
+    int count;
+    int index[4];
+};
+
+struct Mesh {
+    const sgm::vec3* vertices;
+    int vertex_count;
+    const int (*edges)[2];
+    int edge_count;
+    const Face* faces;
+    int face_count;
+};
 
+// out_depth receives 0 at the near plane and 1 at the far plane. It is linear in 1 / z, so it
+// interpolates correctly across screen space.
 bool ProjectPoint(const sgm::vec3& world, const sgm::vec3& cam_pos, float yaw, float pitch,
-                  float fov_rad, float aspect, float near_plane, int width, int height,
-                  sgm::vec2* out) {
+                  float fov_rad, float aspect, float near_plane, float far_plane, int width,
+                  int height, sgm::vec2* out, float* out_depth) {
     sgm::vec3 rel = world - cam_pos;
     sgm::vec3 view = RotateYawPitchRoll(rel, -yaw, -pitch, 0.0f);
     if (view.z <= near_plane) {
@@ -64,6 +54,7 @@ bool ProjectPoint(const sgm::vec3& world, const sgm::vec3& cam_pos, float yaw, f
 
     out->x = (x_ndc * 0.5f + 0.5f) * static_cast<float>(width);
     out->y = (1.0f - (y_ndc * 0.5f + 0.5f)) * static_cast<float>(height);
+    *out_depth = (1.0f / near_plane - 1.0f / view.z) / (1.0f / near_plane - 1.0f / far_plane);
     return true;
 }
 } // namespace
@@ -202,6 +193,10 @@ void Example3DScene::Render(IRenderer& renderer) {
         {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6},
         {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7},
     };
+    const Face cube_faces[] = {
+        {4, {0, 1, 2, 3}}, {4, {4, 5, 6, 7}}, {4, {0, 1, 5, 4}},
+        {4, {3, 2, 6, 7}}, {4, {1, 2, 6, 5}}, {4, {0, 3, 7, 4}},
+    };
     const sgm::vec3 pyramid_vertices[] = {
         {-0.6f, -0.5f, -0.6f}, {0.6f, -0.5f, -0.6f}, {0.6f, -0.5f, 0.6f},
         {-0.6f, -0.5f, 0.6f},  {0.0f, 0.6f, 0.0f},
@@ -209,55 +204,109 @@ void Example3DScene::Render(IRenderer& renderer) {
     const int pyramid_edges[][2] = {
         {0, 1}, {1, 2}, {2, 3}, {3, 0}, {0, 4}, {1, 4}, {2, 4}, {3, 4},
     };
+    const Face pyramid_faces[] = {
+        {4, {0, 1, 2, 3}}, {3, {0, 1, 4, 0}}, {3, {1, 2, 4, 0}},
+        {3, {2, 3, 4, 0}}, {3, {3, 0, 4, 0}},
+    };
+    const Mesh cube_mesh{cube_vertices, 8, cube_edges, 12, cube_faces, 6};
+    const Mesh pyramid_mesh{pyramid_vertices, 5, pyramid_edges, 8, pyramid_faces, 5};
+    const sgm::vec3 light_dir = sgm::normalize(sgm::vec3{0.4f, 0.8f, -0.45f});
+
+    const DepthFormat depth_formats[] = {DepthFormat::None, DepthFormat::Float32,
+                                         DepthFormat::Unorm16};
+    const DepthFormat depth_format = solid_ ? depth_formats[depth_mode_] : DepthFormat::None;
+    renderer.SetDepthFormat(depth_format);
+    const bool depth_test = depth_format != DepthFormat::None;
+    if (depth_test) {
+        renderer.ClearDepth();
+    }
 
+    // With depth testing, nearer shapes go first so hierarchical Z can reject what they hide;
+    // without it, shapes are painted back to front.
+    std::vector<size_t> order;
     for (size_t n = 1; n < nodes_.size(); ++n) {
+        order.push_back(n);
+    }
+    auto distance_sq = [&](size_t n) {
+        sgm::vec3 d{nodes_[n].position[0] - cam_pos.x, nodes_[n].position[1] - cam_pos.y,
+                    nodes_[n].position[2] - cam_pos.z};
+        return sgm::dot(d, d);
+    };
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return depth_test ? distance_sq(a) < distance_sq(b) : distance_sq(a) > distance_sq(b);
+    });
+
+    for (size_t n : order) {
         const Node& node = nodes_[n];
         sgm::vec3 pos{node.position[0], node.position[1], node.position[2]};
         sgm::vec3 rot{node.rotation[0], node.rotation[1], node.rotation[2]};
         sgm::vec3 scale{node.scale[0], node.scale[1], node.scale[2]};
-        Color4f edge_color = Color4f::FromBytes(120, 200, 190, 255);
-
-        if (node.shape == Node::Shape::Cube) {
-            sgm::vec2 projected[8];
-            bool visible[8];
-            for (int i = 0; i < 8; ++i) {
-                sgm::vec3 local = {cube_vertices[i].x * scale.x, cube_vertices[i].y * scale.y,
-                                   cube_vertices[i].z * scale.z};
-                sgm::vec3 world = RotateYawPitchRoll(local, rot.y, rot.x, rot.z);
-                world = world + pos;
-                visible[i] = ProjectPoint(world, cam_pos, yaw, pitch, fov_rad, aspect, near_plane_,
-                                          w, h, &projected[i]);
-            }
-            for (const auto& edge : cube_edges) {
-                int a = edge[0];
-                int b = edge[1];
+        constexpr Color32 edge_color = Color32::FromBytes(120, 200, 190, 255);
+        const Mesh& mesh = node.shape == Node::Shape::Cube ? cube_mesh : pyramid_mesh;
+
+        sgm::vec3 world[8];
+        sgm::vec2 projected[8];
+        float depth[8];
+        bool visible[8];
+        for (int i = 0; i < mesh.vertex_count; ++i) {
+            sgm::vec3 local = {mesh.vertices[i].x * scale.x, mesh.vertices[i].y * scale.y,
+                               mesh.vertices[i].z * scale.z};
+            world[i] = RotateYawPitchRoll(local, rot.y, rot.x, rot.z) + pos;
+            visible[i] = ProjectPoint(world[i], cam_pos, yaw, pitch, fov_rad, aspect, near_plane_,
+                                      far_plane_, w, h, &projected[i], &depth[i]);
+        }
+
+        if (!solid_) {
+            LineSegment lines[12];
+            int line_count = 0;
+            for (int e = 0; e < mesh.edge_count; ++e) {
+                int a = mesh.edges[e][0];
+                int b = mesh.edges[e][1];
                 if (!visible[a] || !visible[b]) {
                     continue;
                 }
-                DrawLine(renderer, static_cast<int>(projected[a].x),
-                         static_cast<int>(projected[a].y), static_cast<int>(projected[b].x),
-                         static_cast<int>(projected[b].y), edge_color);
+                lines[line_count++] = {projected[a].x, projected[a].y, projected[b].x,
+                                       projected[b].y};
             }
-        } else {
-            sgm::vec2 projected[5];
-            bool visible[5];
-            for (int i = 0; i < 5; ++i) {
-                sgm::vec3 local = {pyramid_vertices[i].x * scale.x, pyramid_vertices[i].y * scale.y,
-                                   pyramid_vertices[i].z * scale.z};
-                sgm::vec3 world = RotateYawPitchRoll(local, rot.y, rot.x, rot.z);
-                world = world + pos;
-                visible[i] = ProjectPoint(world, cam_pos, yaw, pitch, fov_rad, aspect, near_plane_,
-                                          w, h, &projected[i]);
+            renderer.DrawLines(lines, static_cast<size_t>(line_count), edge_color,
+                               BlendMode::Replace,
+                               antialias_edges_ ? LineMode::Antialiased : LineMode::Aliased);
+            continue;
+        }
+
+        for (int f = 0; f < mesh.face_count; ++f) {
+            const Face& face = mesh.faces[f];
+            bool face_visible = true;
+            sgm::vec3 centroid{};
+            for (int k = 0; k < face.count; ++k) {
+                face_visible = face_visible && visible[face.index[k]];
+                centroid = centroid + world[face.index[k]];
             }
-            for (const auto& edge : pyramid_edges) {
-                int a = edge[0];
-                int b = edge[1];
-                if (!visible[a] || !visible[b]) {
-                    continue;
-                }
-                DrawLine(renderer, static_cast<int>(projected[a].x),
-                         static_cast<int>(projected[a].y), static_cast<int>(projected[b].x),
-                         static_cast<int>(projected[b].y), edge_color);
+            if (!face_visible) {
+                continue;
+            }
+            centroid = centroid * (1.0f / static_cast<float>(face.count));
+            // Orient the normal away from the shape's center, then drop faces turned away
+            // from the camera.
+            const sgm::vec3& p0 = world[face.index[0]];
+            sgm::vec3 normal = sgm::cross(world[face.index[1]] - p0, world[face.index[2]] - p0);
+            if (sgm::dot(normal, centroid - pos) < 0.0f) {
+                normal = -normal;
+            }
+            if (sgm::dot(normal, centroid - cam_pos) >= 0.0f) {
+                continue;
+            }
+            float shade =
+                0.25f + 0.75f * std::max(0.0f, sgm::dot(sgm::normalize(normal), light_dir));
+            Color32 color = Color32::FromBytes(static_cast<uint8_t>(120.0f * shade),
+                                               static_cast<uint8_t>(200.0f * shade),
+                                               static_cast<uint8_t>(190.0f * shade));
+            auto screen = [&](int index) {
+                return ScreenVertex{projected[index].x, projected[index].y, depth[index]};
+            };
+            for (int k = 1; k + 1 < face.count; ++k) {
+                renderer.FillTriangle(screen(face.index[0]), screen(face.index[k]),
+                                      screen(face.index[k + 1]), color);
             }
         }
     }
@@ -268,6 +317,13 @@ void Example3DScene::DrawSceneGui() {
     ImGui::Checkbox("Animate", &animate_);
     ImGui::SameLine();
     ImGui::DragFloat("Spin", &spin_speed_, 0.05f, 0.0f, 5.0f);
+    ImGui::Checkbox("Solid", &solid_);
+    if (solid_) {
+        const char* depth_modes[] = {"Off", "Float32", "Unorm16"};
+        ImGui::Combo("Depth", &depth_mode_, depth_modes, 3);
+    } else {
+        ImGui::Checkbox("Antialiased Edges", &antialias_edges_);
+    }
     ImGui::Separator();
     for (size_t i = 0; i < nodes_.size(); ++i) {
         bool selected = i == selected_index_;
@@ -29,6 +29,9 @@ class Example3DScene : public IScene {
     std::vector<Node> nodes_;
     size_t selected_index_ = 0;
     bool animate_ = true;
+    bool solid_ = true;
+    int depth_mode_ = 1;
+    bool antialias_edges_ = false;
     float spin_speed_ = 0.6f;
     float orbit_speed_ = 0.5f;
     float orbit_radius_ = 2.0f;
@@ -24,13 +24,20 @@ void makeHeart(std::vector<sgm::vec2>& hearts, float increment = 0.0001f) {
 void HeartScene::OnEnter() {
     makeHeart(hearts_);
     isInitPosition_ = false;
+    dirty_ = true;
 }
 
 void HeartScene::OnExit() {}
 
-void HeartScene::Update(const FrameContext& context) { time_ += context.dt; }
+void HeartScene::Update(const FrameContext& context) {
+    time_ += context.dt;
+    dirty_ = true;
+}
 
-void HeartScene::Reset() { time_ = 0.0f; }
+void HeartScene::Reset() {
+    time_ = 0.0f;
+    dirty_ = true;
+}
 
 void HeartScene::Render(IRenderer& renderer) {
     if (!isInitPosition_) {
@@ -46,23 +53,27 @@ void HeartScene::Render(IRenderer& renderer) {
     float normRadian = sgm::radians(normDeg_);
     float range = (sinf(normRadian) + 1.0f) / 2.0f;
     float scale = amplitude_ * range + scale_;
-    for (auto const& v : hearts_) {
-        float x = v.x;
-        float y = v.y;
-        if (isActiveRotation_) {
-            x = v.x * cosf(normRadian) - v.y * sinf(normRadian);
-            y = v.x * sinf(normRadian) + v.y * cosf(normRadian);
-        }
-        renderer.PutPixel(x * scale + position_.x, y * scale + position_.y, color_);
+    float c = isActiveRotation_ ? cosf(normRadian) : 1.0f;
+    float s = isActiveRotation_ ? sinf(normRadian) : 0.0f;
+
+    coords_.resize(hearts_.size());
+    for (size_t i = 0; i < hearts_.size(); ++i) {
+        const sgm::vec2& v = hearts_[i];
+        float x = v.x * c - v.y * s;
+        float y = v.x * s + v.y * c;
+        coords_[i].x = static_cast<int>(x * scale + position_.x);
+        coords_[i].y = static_cast<int>(y * scale + position_.y);
     }
+    renderer.PutPixels(coords_.data(), coords_.size(), color_, BlendMode::SourceOver);
+    dirty_ = false;
 }
 
 void HeartScene::DrawSceneGui() { ImGui::Text("Degree : %.2f", normDeg_); }
 
 void HeartScene::DrawInspectorGui() {
-    ImGui::DragFloat2("Position", &position_.x);
-    ImGui::DragFloat("Scale", &scale_);
-    ImGui::DragFloat("Amplitude", &amplitude_);
-    ImGui::Checkbox("Is Active Rotation", &isActiveRotation_);
-    ImGui::ColorEdit4("Color", &color_.r);
+    dirty_ |= ImGui::DragFloat2("Position", &position_.x);
+    dirty_ |= ImGui::DragFloat("Scale", &scale_);
+    dirty_ |= ImGui::DragFloat("Amplitude", &amplitude_);
+    dirty_ |= ImGui::Checkbox("Is Active Rotation", &isActiveRotation_);
+    dirty_ |= ImGui::ColorEdit4("Color", &color_.r);
 }
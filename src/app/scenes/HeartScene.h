@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/core/Color4f.h"
+#include "engine/core/PixelCoord.h"
 #include "engine/scene/IScene.h"
 #include "sgm.h"
 
@@ -14,6 +15,7 @@ class HeartScene : public IScene {
     void Reset() override;
     void Update(const FrameContext& context) override;
     void Render(IRenderer& renderer) override;
+    bool OutputChanged() const override { return dirty_; }
     void DrawSceneGui() override;
     void DrawInspectorGui() override;
 
@@ -22,10 +24,13 @@ class HeartScene : public IScene {
     bool isInitPosition_ = false;
     sgm::vec2 position_{0.0f};
     std::vector<sgm::vec2> hearts_;
+    std::vector<PixelCoord> coords_;
     float scale_ = 5.0f;
     float amplitude_ = 5.0f;
     bool isActiveRotation_ = false;
     Color4f color_{1.0f, 1.0f, 1.0f, 1.0f};
 
     float normDeg_ = 0.0f;
+    // Set when time advances or the inspector changes the heart; cleared by Render.
+    bool dirty_ = true;
 };
@@ -1,5 +1,6 @@
 #include "app/scenes/MatScene.h"
 
+#include "engine/core/Color32.h"
 #include "trigonometry.h"
 #include "vec2.h"
 
@@ -44,6 +45,13 @@ void MatScene::Render(IRenderer& renderer) {
         was_rendered_ = true;
     }
 
+    const std::array<float, 4> params = Params();
+    if (!list_.Empty() && params == recorded_params_ && w == list_.Width() &&
+        h == list_.Height()) {
+        list_.Draw(renderer);
+        return;
+    }
+
     float rad = sgm::radians(rotation_deg_);
     matrices_.clear();
     matrices_.push_back({{scale_, 0}, {0, scale_}});
@@ -51,6 +59,8 @@ void MatScene::Render(IRenderer& renderer) {
     matrices_.push_back({{1, 0}, {shear_x_, 1}});
     matrices_.push_back({{1, shear_y_}, {0, 1}});
 
+    coords_.resize(vertices_.size() * box_.size());
+    size_t out = 0;
     for (int i = 0; i < vertices_.size(); ++i) {
         sgm::vec2 start = vertices_[i] + box_offset_;
         sgm::vec2 half = {box_size_ * 0.5f, box_size_ * 0.5f};
@@ -58,11 +68,20 @@ void MatScene::Render(IRenderer& renderer) {
         for (const auto& bv : box_) {
             sgm::vec2 local = bv - half;
             sgm::vec2 pos = matrices_[i] * local + start;
-            renderer.PutPixel(pos.x, pos.y, {1.0f, 1.0f, 1.0f, 1.0f});
+            coords_[out].x = static_cast<int>(pos.x);
+            coords_[out].y = static_cast<int>(pos.y);
+            ++out;
         }
     }
+    list_.Reset();
+    list_.Resize(w, h);
+    list_.PutPixels(coords_.data(), out, Color32::FromBytes(255, 255, 255, 255));
+    recorded_params_ = params;
+    list_.Draw(renderer);
 }
 
+bool MatScene::OutputChanged() const { return list_.Empty() || Params() != recorded_params_; }
+
 void MatScene::DrawSceneGui() {
     ImGui::Text("Transforms");
     ImGui::Separator();
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "engine/core/PixelCoord.h"
+#include "engine/render/DisplayList.h"
 #include "engine/scene/IScene.h"
 #include "mat2.h"
 #include "vec2.h"
 
+#include <array>
 #include <vector>
 
 class MatScene : public IScene {
@@ -19,13 +22,17 @@ class MatScene : public IScene {
     void Reset() override;
     void Update(const FrameContext& context) override;
     void Render(IRenderer& renderer) override;
+    bool OutputChanged() const override;
     void DrawSceneGui() override;
     void DrawInspectorGui() override;
 
   private:
+    std::array<float, 4> Params() const { return {scale_, rotation_deg_, shear_x_, shear_y_}; }
+
     float time_ = 0.0f;
     float box_size_;
     std::vector<sgm::vec2> box_;
+    std::vector<PixelCoord> coords_;
     bool was_rendered_ = false;
     std::vector<sgm::vec2> vertices_;
     sgm::vec2 box_offset_;
@@ -37,4 +44,8 @@ class MatScene : public IScene {
     float rotation_deg_ = 45.0f;
     float shear_x_ = 2.0f;
     float shear_y_ = 2.0f;
+
+    // The boxes, re-recorded only when the sliders or the target size change.
+    DisplayList list_;
+    std::array<float, 4> recorded_params_{};
 };
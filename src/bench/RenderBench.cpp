@@ -0,0 +1,382 @@
+// Microbenchmarks for the CPU renderers. Each workload runs against PixelRenderer in the linear
+// and the tiled layout and against BinnedRenderer, so changes to the rasterizer, memory layout
+// or threading can be compared directly. BinnedRenderer only draws when Pixels() resolves the
+// recorded commands, so its timings include that call.
+//
+// On Linux the data-TLB misses of each workload are read from perf events as well (loads plus
+// stores, where the CPU counts both), which shows what huge-page backed targets save. Reading
+// them may need kernel.perf_event_paranoid lowered; without access that table is skipped.
+//
+//   render_bench [width height [iterations]]
+
+#include "engine/core/Color32.h"
+#include "engine/core/Image.h"
+#include "engine/core/LineSegment.h"
+#include "engine/core/PixelCoord.h"
+#include "engine/render/BinnedRenderer.h"
+#include "engine/render/PixelRenderer.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct Workload {
+    const char* name;
+    std::function<void(IRenderer&)> run;
+};
+
+constexpr float kPi = 3.14159265358979f;
+
+// HeartScene's parametric curve, scaled up and rotated so consecutive points walk across rows.
+std::vector<PixelCoord> MakeHeart(int width, int height) {
+    std::vector<PixelCoord> coords;
+    const float scale = 0.025f * static_cast<float>(std::min(width, height));
+    const float c = std::cos(0.6f);
+    const float s = std::sin(0.6f);
+    for (float rad = 0.0f; rad < kPi * 2.0f; rad += 0.0001f) {
+        float x = 16.0f * std::pow(std::sin(rad), 3.0f);
+        float y = 13.0f * std::cos(rad) - 5.0f * std::cos(2.0f * rad) - 2.0f * std::cos(3.0f * rad) -
+                  std::cos(4.0f * rad);
+        float rx = (x * c - y * s) * scale + width * 0.5f;
+        float ry = (x * s + y * c) * -scale + height * 0.5f;
+        coords.push_back({static_cast<int>(rx), static_cast<int>(ry)});
+    }
+    return coords;
+}
+
+// AffineScene's point box, enlarged and rotated 30 degrees.
+std::vector<PixelCoord> MakeRotatedBox(int width, int height) {
+    std::vector<PixelCoord> coords;
+    const int size = std::min(width, height) / 2;
+    const float c = std::cos(kPi / 6.0f);
+    const float s = std::sin(kPi / 6.0f);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            float fx = static_cast<float>(x - size / 2);
+            float fy = static_cast<float>(y - size / 2);
+            coords.push_back({static_cast<int>(fx * c - fy * s + width * 0.5f),
+                              static_cast<int>(fx * s + fy * c + height * 0.5f)});
+        }
+    }
+    return coords;
+}
+
+// Near-vertical lines, one pixel per row, spread across the target.
+std::vector<PixelCoord> MakeSteepLines(int width, int height) {
+    std::vector<PixelCoord> coords;
+    const int lines = 256;
+    for (int i = 0; i < lines; ++i) {
+        int x0 = (width * i) / lines;
+        for (int y = 0; y < height; ++y) {
+            coords.push_back({x0 + (y * 16) / height, y});
+        }
+    }
+    return coords;
+}
+
+std::vector<PixelCoord> MakeScatter(int width, int height, size_t count) {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> dx(0, width - 1);
+    std::uniform_int_distribution<int> dy(0, height - 1);
+    std::vector<PixelCoord> coords(count);
+    for (PixelCoord& coord : coords) {
+        coord = {dx(rng), dy(rng)};
+    }
+    return coords;
+}
+
+// Random triangles about 60 pixels across, the size of a mid-distance mesh face.
+std::vector<ScreenVertex> MakeTriangles(int width, int height, size_t count) {
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> cx(0.0f, static_cast<float>(width));
+    std::uniform_real_distribution<float> cy(0.0f, static_cast<float>(height));
+    std::uniform_real_distribution<float> offset(-40.0f, 40.0f);
+    std::vector<ScreenVertex> vertices;
+    for (size_t i = 0; i < count; ++i) {
+        float x = cx(rng);
+        float y = cy(rng);
+        for (int k = 0; k < 3; ++k) {
+            vertices.push_back({x + offset(rng), y + offset(rng)});
+        }
+    }
+    return vertices;
+}
+
+// Spokes from inside the target to points far outside it, like projected mesh edges that
+// cross the near plane; only the clipped part is visible.
+std::vector<LineSegment> MakeSpokes(int width, int height, size_t count) {
+    std::vector<LineSegment> lines;
+    const float cx = width * 0.5f;
+    const float cy = height * 0.5f;
+    const float reach = 50.0f * static_cast<float>(std::max(width, height));
+    for (size_t i = 0; i < count; ++i) {
+        const float angle = kPi * 2.0f * static_cast<float>(i) / static_cast<float>(count);
+        lines.push_back({cx, cy, cx + std::cos(angle) * reach, cy + std::sin(angle) * reach});
+    }
+    return lines;
+}
+
+// A size x size sprite with a soft round alpha edge.
+Image MakeSprite(int size, ImageLayout layout) {
+    std::vector<Color32> pixels(static_cast<size_t>(size) * size);
+    const float center = 0.5f * static_cast<float>(size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const float dx = static_cast<float>(x) + 0.5f - center;
+            const float dy = static_cast<float>(y) + 0.5f - center;
+            const float edge = std::max(0.0f, 1.0f - std::sqrt(dx * dx + dy * dy) / center);
+            pixels[static_cast<size_t>(y) * size + x] =
+                Color32::FromBytes(static_cast<uint8_t>(x * 255 / size),
+                                   static_cast<uint8_t>(y * 255 / size), 200,
+                                   static_cast<uint8_t>(std::min(255.0f, edge * 1024.0f)));
+        }
+    }
+    return Image(size, size, pixels.data(), size, layout);
+}
+
+// Data-TLB misses of this process's threads, including ones started after it is opened, so it
+// has to exist before BinnedRenderer spawns its workers.
+class TlbMissCounter {
+  public:
+    TlbMissCounter() {
+#if defined(__linux__)
+        const uint64_t ops[] = {PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_OP_WRITE};
+        for (size_t i = 0; i < 2; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | (ops[i] << 8) |
+                          (uint64_t{PERF_COUNT_HW_CACHE_RESULT_MISS} << 16);
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+    }
+    ~TlbMissCounter() {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+    TlbMissCounter(const TlbMissCounter&) = delete;
+    TlbMissCounter& operator=(const TlbMissCounter&) = delete;
+
+    // Store misses are not counted separately on every CPU; loads alone still make the point.
+    bool Available() const { return fds_[0] >= 0; }
+    uint64_t Read() const {
+        uint64_t total = 0;
+#if defined(__linux__)
+        for (int fd : fds_) {
+            uint64_t value = 0;
+            if (fd >= 0 && read(fd, &value, sizeof(value)) == sizeof(value)) {
+                total += value;
+            }
+        }
+#endif
+        return total;
+    }
+
+  private:
+    int fds_[2] = {-1, -1};
+};
+
+struct Measurement {
+    double ms = 0.0;
+    double tlb_misses = 0.0;
+};
+
+// Average time and TLB misses per iteration.
+Measurement Measure(IRenderer& renderer, const Workload& workload, int iterations, bool resolve,
+                    const TlbMissCounter& tlb) {
+    volatile uint8_t sink = 0;
+    workload.run(renderer); // warm up
+    const uint64_t misses = tlb.Read();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        workload.run(renderer);
+        if (resolve) {
+            sink = sink + renderer.Pixels()[0];
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    Measurement result;
+    result.ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    result.tlb_misses = static_cast<double>(tlb.Read() - misses) / iterations;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int width = 2560;
+    int height = 1440;
+    int iterations = 50;
+    if (argc >= 3) {
+        width = std::max(1, std::atoi(argv[1]));
+        height = std::max(1, std::atoi(argv[2]));
+    }
+    if (argc >= 4) {
+        iterations = std::max(1, std::atoi(argv[3]));
+    }
+
+    const Color32 white = Color32::FromBytes(255, 255, 255);
+    const Color32 tint = Color32::FromBytes(255, 64, 64, 128);
+    const std::vector<PixelCoord> heart = MakeHeart(width, height);
+    const std::vector<PixelCoord> box = MakeRotatedBox(width, height);
+    const std::vector<PixelCoord> steep = MakeSteepLines(width, height);
+    const std::vector<PixelCoord> scatter = MakeScatter(width, height, 200000);
+    const std::vector<ScreenVertex> triangles = MakeTriangles(width, height, 4000);
+    const std::vector<LineSegment> spokes = MakeSpokes(width, height, 1000);
+    const Image sprite = MakeSprite(64, ImageLayout::Linear);
+    const Image texture = MakeSprite(512, ImageLayout::Linear);
+    const Image texture_morton = MakeSprite(512, ImageLayout::Morton);
+    // Large rotated, magnified draws of the 512 texture.
+    auto rotated_blits = [](IRenderer& r, const Image& image) {
+        for (int i = 0; i < 8; ++i) {
+            const float angle = 0.4f + 0.7f * static_cast<float>(i);
+            const float scale = 1.5f;
+            const ImageTransform transform{std::cos(angle) * scale, -std::sin(angle) * scale,
+                                           static_cast<float>((i * 311) % r.Width()),
+                                           std::sin(angle) * scale, std::cos(angle) * scale,
+                                           static_cast<float>((i * 173) % r.Height())};
+            r.BlitTransformed(image, transform, ImageFilter::Bilinear, BlendMode::SourceOver);
+        }
+    };
+
+    volatile unsigned sink = 0;
+    auto frame = [&](IRenderer& r) {
+        r.Clear(Color32::FromBytes(20, 20, 20));
+        r.PutPixels(box.data(), box.size(), white);
+        r.PutPixels(heart.data(), heart.size(), tint, BlendMode::SourceOver);
+        for (int i = 0; i < 64; ++i) {
+            r.FillRect((i * 37) % r.Width(), (i * 53) % r.Height(), 200, 120, tint,
+                       BlendMode::SourceOver);
+        }
+        sink = sink + r.Pixels()[0];
+    };
+    const std::vector<Workload> workloads = {
+        {"clear", [](IRenderer& r) { r.Clear(Color32::FromBytes(20, 20, 20)); }},
+        {"heart points", [&](IRenderer& r) { r.PutPixels(heart.data(), heart.size(), white); }},
+        {"rotated box", [&](IRenderer& r) { r.PutPixels(box.data(), box.size(), white); }},
+        {"steep lines", [&](IRenderer& r) { r.PutPixels(steep.data(), steep.size(), white); }},
+        {"random scatter",
+         [&](IRenderer& r) { r.PutPixels(scatter.data(), scatter.size(), white); }},
+        {"blended rects",
+         [&](IRenderer& r) {
+             for (int i = 0; i < 64; ++i) {
+                 r.FillRect((i * 37) % r.Width(), (i * 53) % r.Height(), 200, 120, tint,
+                            BlendMode::SourceOver);
+             }
+         }},
+        {"circles and rings",
+         [&](IRenderer& r) {
+             const float radius = 0.25f * static_cast<float>(std::min(r.Width(), r.Height()));
+             for (int i = 0; i < 32; ++i) {
+                 const float x = static_cast<float>((i * 97) % r.Width());
+                 const float y = static_cast<float>((i * 61) % r.Height());
+                 r.FillCircle(x, y, radius, tint, BlendMode::SourceOver);
+                 r.StrokeRing(x, y, radius * 1.1f, radius * 1.2f, white);
+             }
+         }},
+        {"clipped lines",
+         [&](IRenderer& r) { r.DrawLines(spokes.data(), spokes.size(), white); }},
+        {"antialiased lines",
+         [&](IRenderer& r) {
+             r.DrawLines(spokes.data(), spokes.size(), tint, BlendMode::SourceOver,
+                         LineMode::Antialiased);
+         }},
+        {"triangles",
+         [&](IRenderer& r) {
+             for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+                 r.FillTriangle(triangles[i], triangles[i + 1], triangles[i + 2], white);
+             }
+         }},
+        {"occluded triangles",
+         [&](IRenderer& r) {
+             // A near full-screen quad followed by triangles it hides entirely; hierarchical Z
+             // should reject nearly all of the second batch.
+             r.SetDepthFormat(DepthFormat::Float32);
+             r.ClearDepth();
+             const float w = static_cast<float>(r.Width());
+             const float h = static_cast<float>(r.Height());
+             r.FillTriangle({0.0f, 0.0f, 0.1f}, {w, 0.0f, 0.1f}, {w, h, 0.1f}, tint);
+             r.FillTriangle({0.0f, 0.0f, 0.1f}, {w, h, 0.1f}, {0.0f, h, 0.1f}, tint);
+             for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+                 ScreenVertex v[3] = {triangles[i], triangles[i + 1], triangles[i + 2]};
+                 for (ScreenVertex& vertex : v) {
+                     vertex.z = 0.5f;
+                 }
+                 r.FillTriangle(v[0], v[1], v[2], white);
+             }
+         }},
+        {"sprite blits",
+         [&](IRenderer& r) {
+             for (int i = 0; i < 2000; ++i) {
+                 r.Blit(sprite, (i * 197) % r.Width() - 32, (i * 131) % r.Height() - 32,
+                        BlendMode::SourceOver);
+             }
+         }},
+        {"rotated bilinear blits", [&](IRenderer& r) { rotated_blits(r, texture); }},
+        {"rotated blits (Morton)", [&](IRenderer& r) { rotated_blits(r, texture_morton); }},
+        {"Pixels() for upload", [&](IRenderer& r) { sink = sink + r.Pixels()[0]; }},
+        {"frame", frame},
+        {"sparse frame",
+         [&](IRenderer& r) {
+             // Most of the target stays at the clear color from one frame to the next.
+             r.Clear(Color32::FromBytes(20, 20, 20));
+             r.FillCircle(0.5f * static_cast<float>(r.Width()),
+                          0.5f * static_cast<float>(r.Height()), 40.0f, white);
+             r.FillRect(10, 10, 5, 5, tint, BlendMode::SourceOver);
+             sink = sink + r.Pixels()[0];
+         }},
+    };
+
+    const TlbMissCounter tlb;
+    PixelRenderer linear(width, height);
+    PixelRenderer tiled(width, height);
+    tiled.SetLayout(FramebufferLayout::Tiled);
+    BinnedRenderer binned(width, height);
+
+    std::printf("%dx%d, %d iterations, %dx%d layout tiles, %zu binning threads\n\n", width,
+                height, iterations, PixelRenderer::kTileSize, PixelRenderer::kTileSize,
+                binned.ThreadCount());
+    std::printf("%-22s %12s %12s %12s\n", "workload", "linear ms", "tiled ms", "binned ms");
+    std::vector<Measurement> results;
+    for (const Workload& workload : workloads) {
+        const Measurement linear_result = Measure(linear, workload, iterations, false, tlb);
+        const Measurement tiled_result = Measure(tiled, workload, iterations, false, tlb);
+        const Measurement binned_result = Measure(binned, workload, iterations, true, tlb);
+        std::printf("%-22s %12.3f %12.3f %12.3f\n", workload.name, linear_result.ms,
+                    tiled_result.ms, binned_result.ms);
+        results.insert(results.end(), {linear_result, tiled_result, binned_result});
+    }
+
+    if (!tlb.Available()) {
+        std::printf("\ndTLB miss counters unavailable\n");
+        return 0;
+    }
+    std::printf("\n%-22s %12s %12s %12s\n", "dTLB misses / iter", "linear", "tiled", "binned");
+    for (size_t i = 0; i < workloads.size(); ++i) {
+        std::printf("%-22s %12.0f %12.0f %12.0f\n", workloads[i].name, results[i * 3].tlb_misses,
+                    results[i * 3 + 1].tlb_misses, results[i * 3 + 2].tlb_misses);
+    }
+    return 0;
+}
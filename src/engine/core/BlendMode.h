@@ -0,0 +1,10 @@
+#pragma once
+
+// How a draw call combines its color with the render target. Source alpha weights every mode
+// except Replace, which overwrites the destination as-is.
+enum class BlendMode {
+    Replace,
+    SourceOver,
+    Additive,
+    Multiply,
+};
@@ -0,0 +1,15 @@
+#include "engine/core/Color32.h"
+
+namespace {
+// Written so NaN maps to 0. Matches the rounding of the span kernels in PixelKernels, so a color
+// converted here and one converted in bulk produce the same bytes.
+uint32_t ToByte(float v) {
+    const float clamped = v > 0.0f ? (v < 1.0f ? v : 1.0f) : 0.0f;
+    return static_cast<uint32_t>(clamped * 255.0f + 0.5f);
+}
+} // namespace
+
+Color32 Color32::FromColor4f(const Color4f& color) {
+    return FromPacked(ToByte(color.r) | (ToByte(color.g) << 8) | (ToByte(color.b) << 16) |
+                      (ToByte(color.a) << 24));
+}
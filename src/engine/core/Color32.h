@@ -0,0 +1,38 @@
+#pragma once
+
+#include "engine/core/Color4f.h"
+
+#include <cstdint>
+
+// RGBA8 color packed into one 32-bit word. In memory the bytes are R, G, B, A (on the
+// little-endian hosts we target), which is exactly what the presenters upload, so writing a
+// Color32 into the render target is a single store.
+struct Color32 {
+    uint32_t rgba = 0xFF000000u;
+
+    constexpr Color32() = default;
+    // Implicit so existing Color4f call sites keep working; the conversion runs once per call,
+    // not once per pixel.
+    Color32(const Color4f& color) : rgba(FromColor4f(color).rgba) {}
+
+    static constexpr Color32 FromBytes(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+        return FromPacked(static_cast<uint32_t>(r) | (static_cast<uint32_t>(g) << 8) |
+                          (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(a) << 24));
+    }
+
+    static constexpr Color32 FromPacked(uint32_t rgba) {
+        Color32 color;
+        color.rgba = rgba;
+        return color;
+    }
+
+    static Color32 FromColor4f(const Color4f& color);
+
+    constexpr uint8_t R() const { return static_cast<uint8_t>(rgba); }
+    constexpr uint8_t G() const { return static_cast<uint8_t>(rgba >> 8); }
+    constexpr uint8_t B() const { return static_cast<uint8_t>(rgba >> 16); }
+    constexpr uint8_t A() const { return static_cast<uint8_t>(rgba >> 24); }
+
+    constexpr bool operator==(const Color32& other) const { return rgba == other.rgba; }
+    constexpr bool operator!=(const Color32& other) const { return rgba != other.rgba; }
+};
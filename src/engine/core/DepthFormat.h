@@ -0,0 +1,9 @@
+#pragma once
+
+// Storage for a renderer's optional depth attachment. Depth runs from 0 (near) to 1 (far) and
+// a fragment passes when it is strictly nearer than the stored value.
+enum class DepthFormat {
+    None,
+    Float32,
+    Unorm16,
+};
@@ -1,18 +1,120 @@
 #pragma once
 
-#include "engine/core/Color4f.h"
+#include "engine/core/BlendMode.h"
+#include "engine/core/Color32.h"
+#include "engine/core/DepthFormat.h"
+#include "engine/core/Image.h"
+#include "engine/core/LineMode.h"
+#include "engine/core/LineSegment.h"
+#include "engine/core/PixelCoord.h"
+#include "engine/core/PixelFormat.h"
+#include "engine/core/PixelRect.h"
+#include "engine/core/RenderStats.h"
+#include "engine/core/ScreenVertex.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 class IRenderer {
   public:
     virtual ~IRenderer() = default;
 
     virtual void Resize(int width, int height) = 0;
-    virtual void Clear(const Color4f& color) = 0;
-    virtual void PutPixel(int x, int y, const Color4f& color) = 0;
+    virtual void Clear(Color32 color) = 0;
+    // Every draw call takes an optional blend mode; Replace ignores alpha and is the fast path.
+    virtual void PutPixel(int x, int y, Color32 color, BlendMode blend = BlendMode::Replace) = 0;
+
+    // Batched writes: coordinates outside the target are skipped, so callers can pass
+    // unclipped points.
+    virtual void PutPixels(const PixelCoord* coords, size_t count, Color32 color,
+                           BlendMode blend = BlendMode::Replace) = 0;
+    virtual void PutPixels(const PixelCoord* coords, const Color32* colors, size_t count,
+                           BlendMode blend = BlendMode::Replace) = 0;
+    virtual void PutSpan(int x, int y, const Color32* colors, size_t count,
+                         BlendMode blend = BlendMode::Replace) = 0;
+
+    // Solid fills, clipped to the target.
+    virtual void FillSpan(int x, int y, int width, Color32 color,
+                          BlendMode blend = BlendMode::Replace) = 0;
+    virtual void FillRect(int x, int y, int width, int height, Color32 color,
+                          BlendMode blend = BlendMode::Replace) = 0;
+    // Sub-pixel vertices, either winding; shared edges follow the top-left fill rule. With a
+    // depth attachment, pixels are depth-tested against the interpolated vertex z and visible
+    // ones store their depth.
+    virtual void FillTriangle(const ScreenVertex& v0, const ScreenVertex& v1,
+                              const ScreenVertex& v2, Color32 color,
+                              BlendMode blend = BlendMode::Replace) = 0;
+
+    // Scanline conics: one span per covered row (two for a ring row crossing the hole). Pixels
+    // whose centers lie inside are filled; StrokeRing covers inner_radius < d <= outer_radius.
+    virtual void FillCircle(float cx, float cy, float radius, Color32 color,
+                            BlendMode blend = BlendMode::Replace) = 0;
+    virtual void FillEllipse(float cx, float cy, float rx, float ry, Color32 color,
+                             BlendMode blend = BlendMode::Replace) = 0;
+    virtual void StrokeRing(float cx, float cy, float inner_radius, float outer_radius,
+                            Color32 color, BlendMode blend = BlendMode::Replace) = 0;
+
+    // Lines are clipped to the target before rasterizing, so endpoints far off screen cost
+    // nothing. Antialiased lines weight the color's alpha by coverage and blend with
+    // SourceOver when blend is Replace. Lines are not depth-tested.
+    virtual void DrawLine(const LineSegment& line, Color32 color,
+                          BlendMode blend = BlendMode::Replace,
+                          LineMode mode = LineMode::Aliased) = 0;
+    virtual void DrawLines(const LineSegment* lines, size_t count, Color32 color,
+                           BlendMode blend = BlendMode::Replace,
+                           LineMode mode = LineMode::Aliased) = 0;
+
+    // Image draws cover the target pixels whose centers map inside the image, clipped to the
+    // target, and write each the image sample there; they are not depth-tested. Blit places the
+    // image 1:1 with its top-left corner at (x, y) and copies rows without sampling.
+    void Blit(const Image& image, int x, int y, BlendMode blend = BlendMode::Replace) {
+        BlitTransformed(image,
+                        ImageTransform::Translation(static_cast<float>(x), static_cast<float>(y)),
+                        ImageFilter::Nearest, blend);
+    }
+    // Stretches the image over [x, x + width) x [y, y + height).
+    void BlitScaled(const Image& image, float x, float y, float width, float height,
+                    ImageFilter filter = ImageFilter::Bilinear,
+                    BlendMode blend = BlendMode::Replace) {
+        BlitTransformed(
+            image, ImageTransform::Stretch(image.Width(), image.Height(), x, y, width, height),
+            filter, blend);
+    }
+    virtual void BlitTransformed(const Image& image, const ImageTransform& transform,
+                                 ImageFilter filter = ImageFilter::Bilinear,
+                                 BlendMode blend = BlendMode::Replace) = 0;
+
+    // Optional depth attachment, cleared to the far plane (1.0) when attached.
+    virtual void SetDepthFormat(DepthFormat format) = 0;
+    virtual DepthFormat GetDepthFormat() const = 0;
+    virtual void ClearDepth(float depth = 1.0f) = 0;
 
     virtual int Width() const = 0;
     virtual int Height() const = 0;
+    // Row-major image of the target in Format(); rows are Pitch() pixels apart.
     virtual const uint8_t* Pixels() const = 0;
+    virtual int Pitch() const { return Width(); }
+    virtual PixelFormat Format() const { return PixelFormat::RGBA8; }
+    // True when nothing was drawn since a Clear of the whole target, whose color is stored in
+    // color. Retained content rasterized over that color can then be copied in instead of
+    // redrawn. Renderers that do not track it report false.
+    virtual bool ClearedTo(Color32* color) const {
+        (void)color;
+        return false;
+    }
+
+    // Regions of Pixels() that may have changed since the last ResetDamage(), as a few
+    // rectangles; empty when nothing did. Presenters upload only these and the caller resets
+    // once the upload is done.
+    virtual const std::vector<PixelRect>& Damage() const = 0;
+    virtual void ResetDamage() = 0;
+
+    // Work counted since the last ResetStats(). Renderers that defer drawing count it once
+    // Pixels() has run it. Renderers that do not count report zeros.
+    virtual const RenderStats& Stats() const {
+        static const RenderStats kNone;
+        return kNone;
+    }
+    virtual void ResetStats() {}
 };
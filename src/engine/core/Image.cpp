@@ -0,0 +1,77 @@
+#include "engine/core/Image.h"
+
+#include <cstddef>
+#include <utility>
+
+namespace {
+int CeilLog2(int value) {
+    int bits = 0;
+    while ((1 << bits) < value) {
+        ++bits;
+    }
+    return bits;
+}
+
+// Spreads the low bits of value to every other bit, starting at bit 0.
+uint32_t SpreadBits(uint32_t value) {
+    value &= 0xFFFFu;
+    value = (value | (value << 8)) & 0x00FF00FFu;
+    value = (value | (value << 4)) & 0x0F0F0F0Fu;
+    value = (value | (value << 2)) & 0x33333333u;
+    value = (value | (value << 1)) & 0x55555555u;
+    return value;
+}
+
+// Offsets of coordinates [0, size) plus the repeated last one. Morton storage pads both sides to
+// powers of two; the low bits shared by both axes interleave (x even, y odd) and the remaining
+// high bits of the longer axis sit above them, so a non-square image wastes no more than the
+// padding. odd selects the y side of the interleave.
+std::vector<uint32_t> MortonOffsets(int size, int shared_bits, bool odd) {
+    std::vector<uint32_t> offsets(static_cast<size_t>(size) + 1);
+    const uint32_t low_mask = (1u << shared_bits) - 1u;
+    for (int i = 0; i < size; ++i) {
+        const uint32_t value = static_cast<uint32_t>(i);
+        offsets[static_cast<size_t>(i)] = (SpreadBits(value & low_mask) << (odd ? 1 : 0)) |
+                                          ((value >> shared_bits) << (2 * shared_bits));
+    }
+    offsets[static_cast<size_t>(size)] = offsets[static_cast<size_t>(size) - 1];
+    return offsets;
+}
+} // namespace
+
+Image::Image(int width, int height, const Color32* pixels, int pitch, ImageLayout layout)
+    : layout_(layout) {
+    if (width <= 0 || height <= 0 || !pixels) {
+        return;
+    }
+    width_ = width;
+    height_ = height;
+    auto storage = std::make_shared<Storage>();
+    storage->columns.resize(static_cast<size_t>(width) + 1);
+    storage->rows.resize(static_cast<size_t>(height) + 1);
+    if (layout == ImageLayout::Linear) {
+        for (int x = 0; x <= width; ++x) {
+            storage->columns[static_cast<size_t>(x)] = static_cast<uint32_t>(x < width ? x : x - 1);
+        }
+        for (int y = 0; y <= height; ++y) {
+            storage->rows[static_cast<size_t>(y)] =
+                static_cast<uint32_t>(y < height ? y : y - 1) * static_cast<uint32_t>(width);
+        }
+        storage->texels.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    } else {
+        const int width_bits = CeilLog2(width);
+        const int height_bits = CeilLog2(height);
+        const int shared_bits = width_bits < height_bits ? width_bits : height_bits;
+        storage->columns = MortonOffsets(width, shared_bits, false);
+        storage->rows = MortonOffsets(height, shared_bits, true);
+        storage->texels.resize(size_t{1} << (width_bits + height_bits));
+    }
+    for (int y = 0; y < height; ++y) {
+        const Color32* src = pixels + static_cast<size_t>(y) * static_cast<size_t>(pitch);
+        Color32* dst = storage->texels.data() + storage->rows[static_cast<size_t>(y)];
+        for (int x = 0; x < width; ++x) {
+            dst[storage->columns[static_cast<size_t>(x)]] = src[x];
+        }
+    }
+    storage_ = std::move(storage);
+}
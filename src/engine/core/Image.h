@@ -0,0 +1,79 @@
+#pragma once
+
+#include "engine/core/Color32.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Storage order of an Image. Morton interleaves the bits of x and y (Z-order), so texels that
+// are close in the image are close in memory whichever direction a sample walks; rotated blits
+// then touch far fewer cache lines than they do stepping across rows of a row-major image.
+enum class ImageLayout {
+    Linear,
+    Morton,
+};
+
+// How scaled and transformed blits sample between texel centers. Bilinear clamps to the edge
+// texels, so the image never blends with anything outside itself.
+enum class ImageFilter {
+    Nearest,
+    Bilinear,
+};
+
+// Affine map from image space to target space, both in pixels with y down:
+// target = (xx * u + xy * v + tx, yx * u + yy * v + ty). Texel (i, j) covers
+// [i, i + 1) x [j, j + 1), like render-target pixels in ScreenVertex.
+struct ImageTransform {
+    float xx = 1.0f;
+    float xy = 0.0f;
+    float tx = 0.0f;
+    float yx = 0.0f;
+    float yy = 1.0f;
+    float ty = 0.0f;
+
+    static constexpr ImageTransform Translation(float x, float y) {
+        return ImageTransform{1.0f, 0.0f, x, 0.0f, 1.0f, y};
+    }
+    // Stretches an image_width x image_height image over [x, x + width) x [y, y + height).
+    static constexpr ImageTransform Stretch(int image_width, int image_height, float x, float y,
+                                            float width, float height) {
+        return ImageTransform{width / static_cast<float>(image_width), 0.0f, x, 0.0f,
+                              height / static_cast<float>(image_height), y};
+    }
+};
+
+// Immutable RGBA8 bitmap for the IRenderer blit calls. Copies share the pixels, so a renderer
+// that defers its draws (BinnedRenderer) keeps an image alive by copying it, not its texels.
+class Image {
+  public:
+    Image() = default;
+    // Copies width x height pixels whose rows are pitch pixels apart.
+    Image(int width, int height, const Color32* pixels, int pitch,
+          ImageLayout layout = ImageLayout::Linear);
+
+    int Width() const { return width_; }
+    int Height() const { return height_; }
+    ImageLayout Layout() const { return layout_; }
+    bool Empty() const { return width_ <= 0 || height_ <= 0; }
+
+    // Texel (x, y) is Texels()[ColumnOffsets()[x] + RowOffsets()[y]] in either layout. Each
+    // table has one extra entry repeating the last texel, so a bilinear footprint starting on
+    // the right or bottom edge stays inside the image.
+    const Color32* Texels() const { return storage_->texels.data(); }
+    const uint32_t* ColumnOffsets() const { return storage_->columns.data(); }
+    const uint32_t* RowOffsets() const { return storage_->rows.data(); }
+    Color32 At(int x, int y) const { return Texels()[ColumnOffsets()[x] + RowOffsets()[y]]; }
+
+  private:
+    struct Storage {
+        std::vector<Color32> texels;
+        std::vector<uint32_t> columns;
+        std::vector<uint32_t> rows;
+    };
+
+    int width_ = 0;
+    int height_ = 0;
+    ImageLayout layout_ = ImageLayout::Linear;
+    std::shared_ptr<const Storage> storage_;
+};
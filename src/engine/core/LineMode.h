@@ -0,0 +1,9 @@
+#pragma once
+
+// Aliased lines set one pixel per step along the major axis and join the pixels containing the
+// endpoints. Antialiased lines split each step between the two nearest pixels by coverage, so
+// they always blend.
+enum class LineMode {
+    Aliased,
+    Antialiased,
+};
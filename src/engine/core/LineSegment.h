@@ -0,0 +1,10 @@
+#pragma once
+
+// Line endpoints in render-target pixels, using the ScreenVertex convention: pixel (x, y) covers
+// [x, x + 1) x [y, y + 1). Endpoints may lie far outside the target; lines are clipped first.
+struct LineSegment {
+    float x0 = 0.0f;
+    float y0 = 0.0f;
+    float x1 = 0.0f;
+    float y1 = 0.0f;
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+struct PixelCoord {
+    int x = 0;
+    int y = 0;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+// Layout of the image a renderer hands to the presenters. Rendering itself always happens in
+// RGBA8; the narrower formats trade color depth for upload bandwidth, and the presenters expand
+// them on the GPU.
+enum class PixelFormat {
+    // Bytes R, G, B, A.
+    RGBA8,
+    // Bytes B, G, R, A, the native order of most display hardware.
+    BGRA8,
+    // 16-bit words, red in the top 5 bits and blue in the bottom 5. Alpha is dropped.
+    RGB565,
+    // One byte per pixel indexing the fixed RGB332 palette (see PalettePixel). Alpha is dropped.
+    Palette8,
+};
+
+inline size_t BytesPerPixel(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGB565:
+        return 2;
+    case PixelFormat::Palette8:
+        return 1;
+    default:
+        return 4;
+    }
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Axis-aligned pixel rectangle: columns [x, x + width) of rows [y, y + height).
+struct PixelRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
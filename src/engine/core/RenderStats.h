@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+// Release builds configured with SANDBOX_RENDER_STATS off define SANDBOX_NO_RENDER_STATS, which
+// compiles the counting out of the renderers and leaves every counter at zero.
+#if defined(SANDBOX_NO_RENDER_STATS)
+constexpr bool kRenderStats = false;
+#else
+constexpr bool kRenderStats = true;
+#endif
+
+// Work a renderer did since its stats were last reset, usually one frame. Full-target clears
+// are not counted: what they cost depends on how much of the target each renderer can skip.
+struct RenderStats {
+    // Pixels stored to the target, counting every write to the same pixel.
+    uint64_t pixels_written = 0;
+    // Pixels of points, spans and rects dropped for lying outside the target.
+    uint64_t pixels_rejected = 0;
+    // Row runs filled by spans, rects, triangles, shapes, aliased lines and image rows.
+    uint64_t spans_filled = 0;
+    // Line segments submitted, clipped away or not.
+    uint64_t lines_drawn = 0;
+    // Bytes of Pixels() sent to the display. Renderers leave it zero; whoever uploads fills it.
+    uint64_t bytes_uploaded = 0;
+
+    RenderStats& operator+=(const RenderStats& other) {
+        pixels_written += other.pixels_written;
+        pixels_rejected += other.pixels_rejected;
+        spans_filled += other.spans_filled;
+        lines_drawn += other.lines_drawn;
+        bytes_uploaded += other.bytes_uploaded;
+        return *this;
+    }
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+// Vertex position in render-target pixels. Pixel (x, y) is sampled at its center
+// (x + 0.5, y + 0.5). z is depth in [0, 1], interpolated linearly in screen space; it is only
+// read when the renderer has a depth attachment.
+struct ScreenVertex {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
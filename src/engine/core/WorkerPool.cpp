@@ -0,0 +1,79 @@
+#include "engine/core/WorkerPool.h"
+
+WorkerPool::WorkerPool(int worker_count) {
+    if (worker_count < 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        worker_count = hardware > 1 ? static_cast<int>(hardware) - 1 : 0;
+    }
+    workers_.reserve(static_cast<size_t>(worker_count));
+    for (int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& job) {
+    if (count == 0) {
+        return;
+    }
+    if (workers_.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        job_count_ = count;
+        next_.store(0, std::memory_order_relaxed);
+        active_ = workers_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+    RunJobs();
+
+    // Every worker checks in before returning, so none still holds a pointer to job.
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0; });
+    job_ = nullptr;
+}
+
+void WorkerPool::WorkerLoop() {
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+        }
+        RunJobs();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_;
+        }
+        done_.notify_one();
+    }
+}
+
+void WorkerPool::RunJobs() {
+    const std::function<void(size_t)>& job = *job_;
+    const size_t count = job_count_;
+    for (size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < count;
+         i = next_.fetch_add(1, std::memory_order_relaxed)) {
+        job(i);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork-join loops. The calling thread works alongside the
+// workers, so a pool with zero workers simply runs the loop inline.
+class WorkerPool {
+  public:
+    // worker_count < 0 picks one worker per hardware thread beyond the caller's.
+    explicit WorkerPool(int worker_count = -1);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Threads that take part in ParallelFor, including the caller.
+    size_t ThreadCount() const { return workers_.size() + 1; }
+
+    // Runs job(i) for every i in [0, count) and returns once all calls have finished. Indices
+    // are handed out one at a time, so uneven jobs balance across threads.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& job);
+
+  private:
+    void WorkerLoop();
+    void RunJobs();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t job_count_ = 0;
+    std::atomic<size_t> next_{0};
+    size_t active_ = 0;
+    unsigned generation_ = 0;
+    bool stopping_ = false;
+};
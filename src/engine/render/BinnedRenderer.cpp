@@ -0,0 +1,717 @@
+#include "engine/render/BinnedRenderer.h"
+
+#include "engine/render/LineRaster.h"
+#include "engine/render/PixelKernels.h"
+#include "engine/render/ShapeRaster.h"
+#include "engine/render/TriangleRaster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+constexpr int kTileShift = 6;
+static_assert((1 << kTileShift) == BinnedRenderer::kTileSize,
+              "kTileShift must match kTileSize");
+} // namespace
+
+BinnedRenderer::BinnedRenderer(int width, int height, int worker_count) : pool_(worker_count) {
+    Resize(width, height);
+}
+
+void BinnedRenderer::Resize(int width, int height) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    tiles_x_ = (width_ + kTileSize - 1) >> kTileShift;
+    tiles_y_ = (height_ + kTileSize - 1) >> kTileShift;
+    pitch_ = PaddedPitch(width_);
+    pixels_.assign(static_cast<size_t>(pitch_) * static_cast<size_t>(height_), Color32{});
+    commands_.clear();
+    span_colors_.clear();
+    triangle_vertices_.clear();
+    line_segments_.clear();
+    shapes_.clear();
+    images_.clear();
+    blits_.clear();
+    bins_.clear();
+    bins_.resize(static_cast<size_t>(tiles_x_) * static_cast<size_t>(tiles_y_));
+    tile_written_.assign(bins_.size(), 0);
+    tile_stats_.assign(kRenderStats ? bins_.size() : 0, RenderStats{});
+    settled_color_ = Color32{};
+    pending_clear_ = false;
+    pending_depth_clear_ = false;
+    depth_.Resize(width_, height_);
+    damage_.Resize(width_, height_);
+}
+
+void BinnedRenderer::Clear(Color32 color) {
+    damage_.MarkCleared(color);
+    if (depth_.Enabled() && !commands_.empty()) {
+        // Depth written by the recorded draws still affects later ones, so only the color is
+        // replaced.
+        Command command;
+        command.type = CommandType::Rect;
+        command.color = color;
+        command.width = width_;
+        command.height = height_;
+        BinRegion(command);
+        return;
+    }
+    // Everything recorded so far would be overwritten, so drop it instead of rasterizing it.
+    commands_.clear();
+    span_colors_.clear();
+    triangle_vertices_.clear();
+    line_segments_.clear();
+    shapes_.clear();
+    images_.clear();
+    blits_.clear();
+    for (TileBin& bin : bins_) {
+        bin.entries.clear();
+        bin.points.clear();
+        bin.point_colors.clear();
+    }
+    pending_clear_ = true;
+    clear_color_ = color;
+}
+
+void BinnedRenderer::PutPixel(int x, int y, Color32 color, BlendMode blend) {
+    const PixelCoord coord{x, y};
+    BinPoints(&coord, nullptr, 1, color, blend);
+}
+
+void BinnedRenderer::PutPixels(const PixelCoord* coords, size_t count, Color32 color,
+                               BlendMode blend) {
+    if (!coords || count == 0) {
+        return;
+    }
+    BinPoints(coords, nullptr, count, color, blend);
+}
+
+void BinnedRenderer::PutPixels(const PixelCoord* coords, const Color32* colors, size_t count,
+                               BlendMode blend) {
+    if (!coords || !colors || count == 0) {
+        return;
+    }
+    BinPoints(coords, colors, count, Color32{}, blend);
+}
+
+void BinnedRenderer::PutSpan(int x, int y, const Color32* colors, size_t count, BlendMode blend) {
+    if (!colors || count == 0) {
+        return;
+    }
+    if (y < 0 || y >= height_) {
+        CountRejected(count);
+        return;
+    }
+    long long begin = x;
+    long long end = begin + static_cast<long long>(count);
+    if (begin < 0) {
+        colors += -begin;
+        begin = 0;
+    }
+    end = std::min<long long>(end, width_);
+    if (begin >= end) {
+        CountRejected(count);
+        return;
+    }
+    CountRejected(count - static_cast<size_t>(end - begin));
+    Command command;
+    command.type = CommandType::Span;
+    command.blend = blend;
+    command.x = static_cast<int>(begin);
+    command.y = y;
+    command.width = static_cast<int>(end - begin);
+    command.height = 1;
+    command.colors = span_colors_.size();
+    span_colors_.insert(span_colors_.end(), colors, colors + command.width);
+    MarkDrawn(command);
+    BinRegion(command);
+}
+
+void BinnedRenderer::FillSpan(int x, int y, int width, Color32 color, BlendMode blend) {
+    FillRect(x, y, width, 1, color, blend);
+}
+
+void BinnedRenderer::FillRect(int x, int y, int width, int height, Color32 color,
+                              BlendMode blend) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    int x0 = std::max(x, 0);
+    int y0 = std::max(y, 0);
+    int x1 = static_cast<int>(std::min<long long>(static_cast<long long>(x) + width, width_));
+    int y1 = static_cast<int>(std::min<long long>(static_cast<long long>(y) + height, height_));
+    const uint64_t area = static_cast<uint64_t>(width) * static_cast<uint64_t>(height);
+    if (x0 >= x1 || y0 >= y1) {
+        CountRejected(area);
+        return;
+    }
+    CountRejected(area - static_cast<uint64_t>(x1 - x0) * static_cast<uint64_t>(y1 - y0));
+    if (blend == BlendMode::SourceOver && color.A() == 255) {
+        blend = BlendMode::Replace;
+    } else if (blend != BlendMode::Replace && color.A() == 0) {
+        return;
+    }
+    if (blend == BlendMode::Replace && x0 == 0 && y0 == 0 && x1 == width_ && y1 == height_) {
+        Clear(color);
+        return;
+    }
+    Command command;
+    command.type = CommandType::Rect;
+    command.blend = blend;
+    command.color = color;
+    command.x = x0;
+    command.y = y0;
+    command.width = x1 - x0;
+    command.height = y1 - y0;
+    MarkDrawn(command);
+    BinRegion(command);
+}
+
+void BinnedRenderer::FillTriangle(const ScreenVertex& v0, const ScreenVertex& v1,
+                                  const ScreenVertex& v2, Color32 color, BlendMode blend) {
+    if (blend == BlendMode::SourceOver && color.A() == 255) {
+        blend = BlendMode::Replace;
+    } else if (blend != BlendMode::Replace && color.A() == 0) {
+        return;
+    }
+    // Bin by the clipped bounding box; tiles it misses are rejected block by block on replay.
+    RasterClip bounds;
+    if (!TriangleBounds(v0, v1, v2, RasterClip{0, 0, width_, height_}, &bounds)) {
+        return;
+    }
+
+    Command command;
+    command.type = CommandType::Triangle;
+    command.blend = blend;
+    command.color = color;
+    command.x = bounds.x0;
+    command.y = bounds.y0;
+    command.width = bounds.x1 - bounds.x0;
+    command.height = bounds.y1 - bounds.y0;
+    command.vertices = triangle_vertices_.size();
+    triangle_vertices_.push_back(v0);
+    triangle_vertices_.push_back(v1);
+    triangle_vertices_.push_back(v2);
+    MarkDrawn(command);
+    BinRegion(command);
+}
+
+void BinnedRenderer::FillCircle(float cx, float cy, float radius, Color32 color,
+                                BlendMode blend) {
+    FillEllipse(cx, cy, radius, radius, color, blend);
+}
+
+void BinnedRenderer::FillEllipse(float cx, float cy, float rx, float ry, Color32 color,
+                                 BlendMode blend) {
+    Shape shape;
+    shape.cx = cx;
+    shape.cy = cy;
+    shape.rx = rx;
+    shape.ry = ry;
+    BinShape(CommandType::Ellipse, shape, color, blend);
+}
+
+void BinnedRenderer::StrokeRing(float cx, float cy, float inner_radius, float outer_radius,
+                                Color32 color, BlendMode blend) {
+    if (!(inner_radius < outer_radius)) {
+        return;
+    }
+    Shape shape;
+    shape.cx = cx;
+    shape.cy = cy;
+    shape.rx = outer_radius;
+    shape.ry = outer_radius;
+    shape.inner = inner_radius;
+    BinShape(CommandType::Ring, shape, color, blend);
+}
+
+void BinnedRenderer::BinShape(CommandType type, const Shape& shape, Color32 color,
+                              BlendMode blend) {
+    if (blend == BlendMode::SourceOver && color.A() == 255) {
+        blend = BlendMode::Replace;
+    } else if (blend != BlendMode::Replace && color.A() == 0) {
+        return;
+    }
+    RasterClip bounds;
+    if (!EllipseBounds(shape.cx, shape.cy, shape.rx, shape.ry, RasterClip{0, 0, width_, height_},
+                       &bounds)) {
+        return;
+    }
+    Command command;
+    command.type = type;
+    command.blend = blend;
+    command.color = color;
+    command.x = bounds.x0;
+    command.y = bounds.y0;
+    command.width = bounds.x1 - bounds.x0;
+    command.height = bounds.y1 - bounds.y0;
+    command.shape = shapes_.size();
+    shapes_.push_back(shape);
+    MarkDrawn(command);
+    BinRegion(command);
+}
+
+void BinnedRenderer::DrawLine(const LineSegment& line, Color32 color, BlendMode blend,
+                              LineMode mode) {
+    DrawLines(&line, 1, color, blend, mode);
+}
+
+void BinnedRenderer::DrawLines(const LineSegment* lines, size_t count, Color32 color,
+                               BlendMode blend, LineMode mode) {
+    if (!lines || count == 0) {
+        return;
+    }
+    if (kRenderStats) {
+        stats_.lines_drawn += count;
+    }
+    if (blend == BlendMode::SourceOver && color.A() == 255 && mode == LineMode::Aliased) {
+        blend = BlendMode::Replace;
+    } else if (blend != BlendMode::Replace && color.A() == 0) {
+        return;
+    }
+    const RasterClip target{0, 0, width_, height_};
+    for (size_t i = 0; i < count; ++i) {
+        LineSegment clipped;
+        if (!ClipLine(lines[i], mode, target, &clipped)) {
+            continue;
+        }
+        Command command;
+        command.type = CommandType::Line;
+        command.blend = blend;
+        command.line_mode = mode;
+        command.color = color;
+        command.line = line_segments_.size();
+        line_segments_.push_back(lines[i]);
+        BinLine(command, clipped);
+    }
+}
+
+void BinnedRenderer::BlitTransformed(const Image& image, const ImageTransform& transform,
+                                     ImageFilter filter, BlendMode blend) {
+    ImageBlit blit;
+    if (!blit.Setup(image, transform, width_, height_)) {
+        return;
+    }
+    Command command;
+    command.type = CommandType::Image;
+    command.blend = blend;
+    command.filter = filter;
+    command.x = blit.Bounds().x;
+    command.y = blit.Bounds().y;
+    command.width = blit.Bounds().width;
+    command.height = blit.Bounds().height;
+    command.image = images_.size();
+    // The copy shares the image's texels, so recording costs no pixel copies.
+    images_.push_back(image);
+    blits_.push_back(blit);
+    MarkDrawn(command);
+    BinRegion(command);
+}
+
+void BinnedRenderer::SetDepthFormat(DepthFormat format) {
+    if (format == depth_.Format()) {
+        return;
+    }
+    Flush();
+    depth_.SetFormat(format);
+    pending_depth_clear_ = false;
+}
+
+void BinnedRenderer::ClearDepth(float depth) {
+    if (!depth_.Enabled()) {
+        return;
+    }
+    if (commands_.empty()) {
+        pending_depth_clear_ = true;
+        clear_depth_ = depth;
+        return;
+    }
+    Command command;
+    command.type = CommandType::DepthClear;
+    command.width = width_;
+    command.height = height_;
+    command.depth = depth;
+    BinRegion(command);
+}
+
+const uint8_t* BinnedRenderer::Pixels() const {
+    // Pixels() is the resolve point for recorded work; the visible result is the same as if
+    // every call had drawn immediately.
+    const_cast<BinnedRenderer*>(this)->Flush();
+    return reinterpret_cast<const uint8_t*>(pixels_.data());
+}
+
+void BinnedRenderer::BinPoints(const PixelCoord* coords, const Color32* colors, size_t count,
+                               Color32 color, BlendMode blend) {
+    if (!colors) {
+        if (blend == BlendMode::SourceOver && color.A() == 255) {
+            blend = BlendMode::Replace;
+        } else if (blend != BlendMode::Replace && color.A() == 0) {
+            return;
+        }
+    }
+    const uint32_t id = static_cast<uint32_t>(commands_.size());
+    Command command;
+    command.type = colors ? CommandType::ColoredPoints : CommandType::Points;
+    command.blend = blend;
+    command.color = color;
+    commands_.push_back(command);
+
+    // Points keep their submission order inside each tile, which is all the ordering a tile
+    // can observe.
+    const unsigned width = static_cast<unsigned>(width_);
+    const unsigned height = static_cast<unsigned>(height_);
+    const size_t tiles_x = static_cast<size_t>(tiles_x_);
+    unsigned min_x = width;
+    unsigned min_y = height;
+    unsigned max_x = 0;
+    unsigned max_y = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned x = static_cast<unsigned>(coords[i].x);
+        const unsigned y = static_cast<unsigned>(coords[i].y);
+        if (x >= width || y >= height) {
+            CountRejected(1);
+            continue;
+        }
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+        TileBin& bin = bins_[(y >> kTileShift) * tiles_x + (x >> kTileShift)];
+        if (bin.entries.empty() || bin.entries.back().command != id) {
+            BinEntry entry;
+            entry.command = id;
+            entry.first_point = static_cast<uint32_t>(bin.points.size());
+            entry.first_color = static_cast<uint32_t>(bin.point_colors.size());
+            bin.entries.push_back(entry);
+        }
+        bin.points.push_back(coords[i]);
+        if (colors) {
+            bin.point_colors.push_back(colors[i]);
+        }
+        ++bin.entries.back().point_count;
+    }
+    if (min_x <= max_x) {
+        damage_.MarkDrawn(static_cast<int>(min_x), static_cast<int>(min_y),
+                          static_cast<int>(max_x) + 1, static_cast<int>(max_y) + 1);
+    }
+}
+
+void BinnedRenderer::MarkDrawn(const Command& command) {
+    damage_.MarkDrawn(command.x, command.y, command.x + command.width, command.y + command.height);
+}
+
+void BinnedRenderer::BinRegion(const Command& command) {
+    const uint32_t id = static_cast<uint32_t>(commands_.size());
+    commands_.push_back(command);
+    const int tx0 = command.x >> kTileShift;
+    const int ty0 = command.y >> kTileShift;
+    const int tx1 = (command.x + command.width - 1) >> kTileShift;
+    const int ty1 = (command.y + command.height - 1) >> kTileShift;
+    BinEntry entry;
+    entry.command = id;
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            bins_[static_cast<size_t>(ty) * tiles_x_ + tx].entries.push_back(entry);
+        }
+    }
+}
+
+// Bins a line into the tiles along its clipped segment rather than its whole bounding box, so a
+// long diagonal costs one tile row's worth of entries per band instead of every tile under it.
+void BinnedRenderer::BinLine(const Command& command, const LineSegment& clipped) {
+    const uint32_t id = static_cast<uint32_t>(commands_.size());
+    commands_.push_back(command);
+    // Rasterized pixels stay within a pixel of the segment (aliased endpoints are floored);
+    // antialiased lines also touch the neighbouring pixel.
+    const float pad = command.line_mode == LineMode::Antialiased ? 3.0f : 2.0f;
+    const float dx = clipped.x1 - clipped.x0;
+    const float dy = clipped.y1 - clipped.y0;
+    const float y_min = std::min(clipped.y0, clipped.y1) - pad;
+    const float y_max = std::max(clipped.y0, clipped.y1) + pad;
+    const int ty0 = std::max(0, static_cast<int>(std::floor(y_min)) >> kTileShift);
+    const int ty1 = std::min(tiles_y_ - 1, static_cast<int>(std::floor(y_max)) >> kTileShift);
+    damage_.MarkDrawn(static_cast<int>(std::floor(std::min(clipped.x0, clipped.x1) - pad)),
+                      static_cast<int>(std::floor(y_min)),
+                      static_cast<int>(std::floor(std::max(clipped.x0, clipped.x1) + pad)) + 1,
+                      static_cast<int>(std::floor(y_max)) + 1);
+    BinEntry entry;
+    entry.command = id;
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        // Part of the segment inside this tile row, grown by pad.
+        float t0 = 0.0f;
+        float t1 = 1.0f;
+        if (dy != 0.0f) {
+            const float band_y0 = static_cast<float>(ty << kTileShift) - pad;
+            const float band_y1 = static_cast<float>((ty + 1) << kTileShift) + pad;
+            t0 = (band_y0 - clipped.y0) / dy;
+            t1 = (band_y1 - clipped.y0) / dy;
+            if (t0 > t1) {
+                std::swap(t0, t1);
+            }
+            t0 = std::max(t0, 0.0f);
+            t1 = std::min(t1, 1.0f);
+            if (t0 > t1) {
+                continue;
+            }
+        }
+        const float xa = clipped.x0 + dx * t0;
+        const float xb = clipped.x0 + dx * t1;
+        const int x_min = static_cast<int>(std::floor(std::min(xa, xb) - pad));
+        const int x_max = static_cast<int>(std::floor(std::max(xa, xb) + pad));
+        const int tx0 = std::max(0, x_min >> kTileShift);
+        const int tx1 = std::min(tiles_x_ - 1, x_max >> kTileShift);
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            bins_[static_cast<size_t>(ty) * tiles_x_ + tx].entries.push_back(entry);
+        }
+    }
+}
+
+void BinnedRenderer::Flush() {
+    if (!pending_clear_ && !pending_depth_clear_ && commands_.empty()) {
+        return;
+    }
+    if (pending_depth_clear_) {
+        pool_.ParallelFor(static_cast<size_t>(tiles_y_), [this](size_t band) {
+            const int y0 = static_cast<int>(band) * kTileSize;
+            depth_.Clear(clear_depth_, 0, y0, width_, y0 + kTileSize);
+        });
+    }
+    // A clear to the color the target was last cleared to only needs to reach the tiles drawn
+    // since; RasterizeTile does that per tile, just before the tile's own commands.
+    const bool tile_clear = pending_clear_ && clear_color_ == settled_color_;
+    if (pending_clear_ && !tile_clear) {
+        // Clearing whole tile rows keeps each fill contiguous, which lets large targets use
+        // streaming stores like PixelRenderer::Clear.
+        const bool stream = pixels_.size() * sizeof(Color32) >= kStreamingFillBytes;
+        pool_.ParallelFor(static_cast<size_t>(tiles_y_), [this, stream](size_t band) {
+            const size_t first = band * kTileSize * static_cast<size_t>(pitch_);
+            const size_t count =
+                std::min(pixels_.size() - first, static_cast<size_t>(kTileSize) * pitch_);
+            if (stream) {
+                FillPixelsStreaming(pixels_.data() + first, count, clear_color_);
+                StreamFence();
+            } else {
+                FillPixels(pixels_.data() + first, count, clear_color_);
+            }
+        });
+    }
+    if (pending_clear_ && !tile_clear) {
+        std::fill(tile_written_.begin(), tile_written_.end(), 0);
+        settled_color_ = clear_color_;
+    }
+    pool_.ParallelFor(bins_.size(),
+                      [this, tile_clear](size_t tile) { RasterizeTile(tile, tile_clear); });
+    if (kRenderStats) {
+        for (RenderStats& tile : tile_stats_) {
+            stats_ += tile;
+            tile = RenderStats{};
+        }
+    }
+
+    commands_.clear();
+    span_colors_.clear();
+    triangle_vertices_.clear();
+    line_segments_.clear();
+    shapes_.clear();
+    images_.clear();
+    blits_.clear();
+    for (TileBin& bin : bins_) {
+        bin.entries.clear();
+        bin.points.clear();
+        bin.point_colors.clear();
+    }
+    pending_clear_ = false;
+    pending_depth_clear_ = false;
+}
+
+void BinnedRenderer::RasterizeTile(size_t tile, bool clear) {
+    const TileBin& bin = bins_[tile];
+    const int tile_x0 = static_cast<int>(tile % static_cast<size_t>(tiles_x_)) << kTileShift;
+    const int tile_y0 = static_cast<int>(tile / static_cast<size_t>(tiles_x_)) << kTileShift;
+    const int tile_x1 = std::min(tile_x0 + kTileSize, width_);
+    const int tile_y1 = std::min(tile_y0 + kTileSize, height_);
+    const size_t stride = static_cast<size_t>(pitch_);
+    Color32* pixels = pixels_.data();
+    if (clear) {
+        if (tile_written_[tile]) {
+            for (int y = tile_y0; y < tile_y1; ++y) {
+                FillPixels(pixels + y * stride + tile_x0, static_cast<size_t>(tile_x1 - tile_x0),
+                           clear_color_);
+            }
+        }
+        tile_written_[tile] = !bin.entries.empty();
+    } else if (!bin.entries.empty()) {
+        tile_written_[tile] = 1;
+    }
+    if (bin.entries.empty()) {
+        return;
+    }
+
+    // Workers count into a local and publish once, so neighbouring tiles do not share the line.
+    RenderStats stats;
+    auto count_span = [&stats](int count) {
+        if (kRenderStats) {
+            ++stats.spans_filled;
+            stats.pixels_written += static_cast<uint64_t>(count);
+        }
+    };
+    for (const BinEntry& entry : bin.entries) {
+        const Command& command = commands_[entry.command];
+        switch (command.type) {
+        case CommandType::Points: {
+            const PixelCoord* points = bin.points.data() + entry.first_point;
+            const Color32 color = command.color;
+            const BlendMode blend = command.blend;
+            for (uint32_t i = 0; i < entry.point_count; ++i) {
+                Color32& pixel = pixels[points[i].y * stride + points[i].x];
+                pixel = blend == BlendMode::Replace ? color : BlendPixel(pixel, color, blend);
+            }
+            stats.pixels_written += kRenderStats ? entry.point_count : 0;
+            break;
+        }
+        case CommandType::ColoredPoints: {
+            const PixelCoord* points = bin.points.data() + entry.first_point;
+            const Color32* colors = bin.point_colors.data() + entry.first_color;
+            const BlendMode blend = command.blend;
+            for (uint32_t i = 0; i < entry.point_count; ++i) {
+                Color32& pixel = pixels[points[i].y * stride + points[i].x];
+                pixel =
+                    blend == BlendMode::Replace ? colors[i] : BlendPixel(pixel, colors[i], blend);
+            }
+            stats.pixels_written += kRenderStats ? entry.point_count : 0;
+            break;
+        }
+        case CommandType::Span: {
+            const int x0 = std::max(command.x, tile_x0);
+            const int x1 = std::min(command.x + command.width, tile_x1);
+            BlendSpan(pixels + command.y * stride + x0,
+                      span_colors_.data() + command.colors + (x0 - command.x),
+                      static_cast<size_t>(x1 - x0), command.blend);
+            count_span(x1 - x0);
+            break;
+        }
+        case CommandType::Rect: {
+            const int x0 = std::max(command.x, tile_x0);
+            const int x1 = std::min(command.x + command.width, tile_x1);
+            const int y0 = std::max(command.y, tile_y0);
+            const int y1 = std::min(command.y + command.height, tile_y1);
+            for (int y = y0; y < y1; ++y) {
+                BlendFill(pixels + y * stride + x0, static_cast<size_t>(x1 - x0), command.color,
+                          command.blend);
+                count_span(x1 - x0);
+            }
+            break;
+        }
+        case CommandType::Triangle: {
+            // Tiles rasterize concurrently, so each worker keeps its own span scratch.
+            thread_local std::vector<CoverageSpan> spans;
+            thread_local std::vector<CoverageSpan> visible;
+            const ScreenVertex* v = triangle_vertices_.data() + command.vertices;
+            const RasterClip clip{std::max(command.x, tile_x0), std::max(command.y, tile_y0),
+                                  std::min(command.x + command.width, tile_x1),
+                                  std::min(command.y + command.height, tile_y1)};
+            DepthPlane plane;
+            const bool depth_test = depth_.Enabled();
+            if (depth_test && (!DepthPlane::FromTriangle(v[0], v[1], v[2], &plane) ||
+                               depth_.Occluded(clip.x0, clip.y0, clip.x1, clip.y1,
+                                               std::min({v[0].z, v[1].z, v[2].z})))) {
+                break;
+            }
+            spans.clear();
+            RasterizeTriangle(v[0], v[1], v[2], clip, spans);
+            if (depth_test) {
+                visible.clear();
+                for (const CoverageSpan& span : spans) {
+                    depth_.TestSpan(span, plane, visible);
+                }
+                depth_.RefreshHiZ(clip.x0, clip.y0, clip.x1, clip.y1);
+            }
+            for (const CoverageSpan& span : depth_test ? visible : spans) {
+                BlendFill(pixels + span.y * stride + span.x, static_cast<size_t>(span.count),
+                          command.color, command.blend);
+                count_span(span.count);
+            }
+            break;
+        }
+        case CommandType::Line: {
+            thread_local std::vector<CoverageSpan> spans;
+            thread_local std::vector<CoveragePixel> covered;
+            const LineSegment& line = line_segments_[command.line];
+            // The full target drives clipping so every tile sees the same segment.
+            const RasterClip target{0, 0, width_, height_};
+            const RasterClip clip{tile_x0, tile_y0, tile_x1, tile_y1};
+            if (command.line_mode == LineMode::Aliased) {
+                spans.clear();
+                RasterizeLine(line, target, clip, spans);
+                for (const CoverageSpan& span : spans) {
+                    BlendFill(pixels + span.y * stride + span.x, static_cast<size_t>(span.count),
+                              command.color, command.blend);
+                    count_span(span.count);
+                }
+                break;
+            }
+            covered.clear();
+            RasterizeLineAA(line, target, clip, covered);
+            for (const CoveragePixel& pixel : covered) {
+                Color32& dst = pixels[pixel.y * stride + pixel.x];
+                dst = BlendCoverage(dst, command.color, pixel.coverage, command.blend);
+            }
+            stats.pixels_written += kRenderStats ? covered.size() : 0;
+            break;
+        }
+        case CommandType::Ellipse:
+        case CommandType::Ring: {
+            thread_local std::vector<CoverageSpan> spans;
+            const Shape& shape = shapes_[command.shape];
+            const RasterClip clip{std::max(command.x, tile_x0), std::max(command.y, tile_y0),
+                                  std::min(command.x + command.width, tile_x1),
+                                  std::min(command.y + command.height, tile_y1)};
+            spans.clear();
+            if (command.type == CommandType::Ellipse) {
+                RasterizeEllipse(shape.cx, shape.cy, shape.rx, shape.ry, clip, spans);
+            } else {
+                RasterizeRing(shape.cx, shape.cy, shape.inner, shape.rx, clip, spans);
+            }
+            for (const CoverageSpan& span : spans) {
+                BlendFill(pixels + span.y * stride + span.x, static_cast<size_t>(span.count),
+                          command.color, command.blend);
+                count_span(span.count);
+            }
+            break;
+        }
+        case CommandType::Image: {
+            thread_local std::vector<Color32> samples;
+            const Image& image = images_[command.image];
+            const ImageBlit& blit = blits_[command.image];
+            const int y0 = std::max(command.y, tile_y0);
+            const int y1 = std::min(command.y + command.height, tile_y1);
+            for (int y = y0; y < y1; ++y) {
+                int x0 = 0;
+                int x1 = 0;
+                if (!blit.RowSpan(y, tile_x0, tile_x1, &x0, &x1)) {
+                    continue;
+                }
+                const size_t count = static_cast<size_t>(x1 - x0);
+                count_span(x1 - x0);
+                Color32* dst = pixels + y * stride + x0;
+                if (command.blend == BlendMode::Replace) {
+                    blit.Sample(image, command.filter, x0, y, dst, count);
+                    continue;
+                }
+                samples.resize(count);
+                blit.Sample(image, command.filter, x0, y, samples.data(), count);
+                BlendSpan(dst, samples.data(), count, command.blend);
+            }
+            break;
+        }
+        case CommandType::DepthClear:
+            depth_.Clear(command.depth, tile_x0, tile_y0, tile_x1, tile_y1);
+            break;
+        }
+    }
+    if (kRenderStats) {
+        tile_stats_[tile] = stats;
+    }
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "engine/core/IRenderer.h"
+#include "engine/core/WorkerPool.h"
+#include "engine/render/DamageTracker.h"
+#include "engine/render/DepthBuffer.h"
+#include "engine/render/FramebufferAllocator.h"
+#include "engine/render/ImageBlit.h"
+
+#include <cstdint>
+#include <vector>
+
+// IRenderer that records draw calls instead of executing them. Each call is binned into the
+// kTileSize x kTileSize screen tiles it touches, and Pixels() rasterizes the tiles in parallel
+// on a WorkerPool. Tiles are disjoint and every tile replays its commands in submission order,
+// so the result matches PixelRenderer pixel for pixel.
+class BinnedRenderer : public IRenderer {
+  public:
+    static constexpr int kTileSize = 64;
+
+    // worker_count follows WorkerPool: negative picks one per spare hardware thread.
+    BinnedRenderer(int width, int height, int worker_count = -1);
+
+    void Resize(int width, int height) override;
+    void Clear(Color32 color) override;
+    void PutPixel(int x, int y, Color32 color, BlendMode blend = BlendMode::Replace) override;
+    void PutPixels(const PixelCoord* coords, size_t count, Color32 color,
+                   BlendMode blend = BlendMode::Replace) override;
+    void PutPixels(const PixelCoord* coords, const Color32* colors, size_t count,
+                   BlendMode blend = BlendMode::Replace) override;
+    void PutSpan(int x, int y, const Color32* colors, size_t count,
+                 BlendMode blend = BlendMode::Replace) override;
+    void FillSpan(int x, int y, int width, Color32 color,
+                  BlendMode blend = BlendMode::Replace) override;
+    void FillRect(int x, int y, int width, int height, Color32 color,
+                  BlendMode blend = BlendMode::Replace) override;
+    void FillTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2,
+                      Color32 color, BlendMode blend = BlendMode::Replace) override;
+    void FillCircle(float cx, float cy, float radius, Color32 color,
+                    BlendMode blend = BlendMode::Replace) override;
+    void FillEllipse(float cx, float cy, float rx, float ry, Color32 color,
+                     BlendMode blend = BlendMode::Replace) override;
+    void StrokeRing(float cx, float cy, float inner_radius, float outer_radius, Color32 color,
+                    BlendMode blend = BlendMode::Replace) override;
+    void DrawLine(const LineSegment& line, Color32 color, BlendMode blend = BlendMode::Replace,
+                  LineMode mode = LineMode::Aliased) override;
+    void DrawLines(const LineSegment* lines, size_t count, Color32 color,
+                   BlendMode blend = BlendMode::Replace,
+                   LineMode mode = LineMode::Aliased) override;
+    void BlitTransformed(const Image& image, const ImageTransform& transform,
+                         ImageFilter filter = ImageFilter::Bilinear,
+                         BlendMode blend = BlendMode::Replace) override;
+
+    void SetDepthFormat(DepthFormat format) override;
+    DepthFormat GetDepthFormat() const override { return depth_.Format(); }
+    void ClearDepth(float depth = 1.0f) override;
+
+    int Width() const override { return width_; }
+    int Height() const override { return height_; }
+    int Pitch() const override { return pitch_; }
+    // Rasterizes everything recorded since the last call.
+    const uint8_t* Pixels() const override;
+    bool ClearedTo(Color32* color) const override { return damage_.ClearedTo(color); }
+    // Recorded draws count as damage as soon as they are recorded.
+    const std::vector<PixelRect>& Damage() const override { return damage_.Rects(); }
+    void ResetDamage() override { damage_.Reset(); }
+    // Pixels and spans are counted as the tiles rasterize, so they lag until Pixels().
+    const RenderStats& Stats() const override { return stats_; }
+    void ResetStats() override { stats_ = RenderStats{}; }
+
+    size_t ThreadCount() const { return pool_.ThreadCount(); }
+
+  private:
+    enum class CommandType : uint8_t {
+        Points,
+        ColoredPoints,
+        Span,
+        Rect,
+        Triangle,
+        Line,
+        Ellipse,
+        Ring,
+        Image,
+        DepthClear,
+    };
+
+    struct Command {
+        CommandType type = CommandType::Rect;
+        BlendMode blend = BlendMode::Replace;
+        LineMode line_mode = LineMode::Aliased;
+        ImageFilter filter = ImageFilter::Bilinear;
+        Color32 color;
+        // Clipped target rect for Span and Rect; clipped bounds for Triangle, Ellipse, Ring,
+        // Image.
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        // Index of the first span color in span_colors_ that lands at x.
+        size_t colors = 0;
+        // Index of the first of three vertices in triangle_vertices_.
+        size_t vertices = 0;
+        // Index of the segment in line_segments_.
+        size_t line = 0;
+        // Index of the center and radii in shapes_.
+        size_t shape = 0;
+        // Index of the image and its setup in images_ and blits_.
+        size_t image = 0;
+        float depth = 1.0f;
+    };
+
+    // Ellipse radii are rx and ry; a ring uses inner and outer (rx).
+    struct Shape {
+        float cx = 0.0f;
+        float cy = 0.0f;
+        float rx = 0.0f;
+        float ry = 0.0f;
+        float inner = 0.0f;
+    };
+
+    // A command's share of one tile. Point commands also own a run of the tile's points.
+    struct BinEntry {
+        uint32_t command = 0;
+        uint32_t first_point = 0;
+        uint32_t point_count = 0;
+        uint32_t first_color = 0;
+    };
+
+    struct TileBin {
+        std::vector<BinEntry> entries;
+        std::vector<PixelCoord> points;
+        std::vector<Color32> point_colors;
+    };
+
+    void Flush();
+    void BinPoints(const PixelCoord* coords, const Color32* colors, size_t count, Color32 color,
+                   BlendMode blend);
+    void BinRegion(const Command& command);
+    void MarkDrawn(const Command& command);
+    void BinLine(const Command& command, const LineSegment& clipped);
+    void BinShape(CommandType type, const Shape& shape, Color32 color, BlendMode blend);
+    // clear: fill the tile with clear_color_ first if it was drawn since the last clear.
+    void RasterizeTile(size_t tile, bool clear);
+    void CountRejected(uint64_t count) {
+        if (kRenderStats) {
+            stats_.pixels_rejected += count;
+        }
+    }
+
+    int width_ = 0;
+    int height_ = 0;
+    int pitch_ = 0;
+    int tiles_x_ = 0;
+    int tiles_y_ = 0;
+    // Rows are pitch_ pixels apart, padded to whole cache lines.
+    FramebufferVector<Color32> pixels_;
+
+    std::vector<Command> commands_;
+    std::vector<TileBin> bins_;
+    std::vector<Color32> span_colors_;
+    std::vector<ScreenVertex> triangle_vertices_;
+    std::vector<LineSegment> line_segments_;
+    std::vector<Shape> shapes_;
+    std::vector<Image> images_;
+    std::vector<ImageBlit> blits_;
+    bool pending_clear_ = false;
+    Color32 clear_color_;
+    // Tiles drawn since the target last held settled_color_ everywhere. Bytes rather than
+    // vector<bool> so workers can update their own tiles concurrently.
+    std::vector<uint8_t> tile_written_;
+    // What each tile's worker counted during the last Flush, summed into stats_ afterwards.
+    std::vector<RenderStats> tile_stats_;
+    RenderStats stats_;
+    Color32 settled_color_;
+    bool pending_depth_clear_ = false;
+    float clear_depth_ = 1.0f;
+    DepthBuffer depth_;
+    DamageTracker damage_;
+
+    WorkerPool pool_;
+};
@@ -0,0 +1,106 @@
+#include "engine/render/DamageTracker.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+int64_t Area(const PixelRect& rect) { return int64_t{rect.width} * rect.height; }
+
+PixelRect Union(const PixelRect& a, const PixelRect& b) {
+    const int x0 = std::min(a.x, b.x);
+    const int y0 = std::min(a.y, b.y);
+    const int x1 = std::max(a.x + a.width, b.x + b.width);
+    const int y1 = std::max(a.y + a.height, b.y + b.height);
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+bool Contains(const PixelRect& outer, const PixelRect& inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.width <= outer.x + outer.width &&
+           inner.y + inner.height <= outer.y + outer.height;
+}
+} // namespace
+
+void DamageTracker::Resize(int width, int height) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    drawn_.clear();
+    clear_known_ = false;
+    MarkAll();
+}
+
+void DamageTracker::MarkAll() {
+    damage_.clear();
+    if (width_ > 0 && height_ > 0) {
+        damage_.push_back({0, 0, width_, height_});
+    }
+}
+
+void DamageTracker::MarkDrawn(int x0, int y0, int x1, int y1) {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, width_);
+    y1 = std::min(y1, height_);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    const PixelRect rect{x0, y0, x1 - x0, y1 - y0};
+    Add(damage_, rect);
+    Add(drawn_, rect);
+}
+
+void DamageTracker::MarkCleared(Color32 color) {
+    if (clear_known_ && color == clear_color_) {
+        // Everything outside drawn_ already holds this color.
+        for (const PixelRect& rect : drawn_) {
+            Add(damage_, rect);
+        }
+    } else {
+        MarkAll();
+    }
+    drawn_.clear();
+    clear_known_ = true;
+    clear_color_ = color;
+}
+
+void DamageTracker::Reset() { damage_.clear(); }
+
+bool DamageTracker::ClearedTo(Color32* color) const {
+    if (!clear_known_ || !drawn_.empty()) {
+        return false;
+    }
+    *color = clear_color_;
+    return true;
+}
+
+void DamageTracker::Add(std::vector<PixelRect>& rects, const PixelRect& rect) {
+    for (const PixelRect& existing : rects) {
+        if (Contains(existing, rect)) {
+            return;
+        }
+    }
+    rects.erase(std::remove_if(rects.begin(), rects.end(),
+                               [&](const PixelRect& existing) { return Contains(rect, existing); }),
+                rects.end());
+    rects.push_back(rect);
+    while (rects.size() > kMaxRects) {
+        // Merge the pair that adds the least uncovered area.
+        size_t best_a = 0;
+        size_t best_b = 1;
+        int64_t best_cost = INT64_MAX;
+        for (size_t a = 0; a < rects.size(); ++a) {
+            for (size_t b = a + 1; b < rects.size(); ++b) {
+                const int64_t cost =
+                    Area(Union(rects[a], rects[b])) - Area(rects[a]) - Area(rects[b]);
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_a = a;
+                    best_b = b;
+                }
+            }
+        }
+        rects[best_a] = Union(rects[best_a], rects[best_b]);
+        rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(best_b));
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "engine/core/Color32.h"
+#include "engine/core/PixelRect.h"
+
+#include <cstddef>
+#include <vector>
+
+// Tracks which parts of a render target may differ from what a consumer (a presenter upload,
+// a detile pass) last saw, as a handful of rectangles.
+//
+// Draws mark their bounds. A full-target clear to the same color as the previous one only
+// reverts what was drawn since then, so a scene that redraws the same few pixels every frame
+// stays a few small rects instead of the whole target.
+class DamageTracker {
+  public:
+    // Beyond this many rects the pair whose union grows least is merged.
+    static constexpr size_t kMaxRects = 8;
+
+    // Marks the whole target; the clear color is unknown until the next MarkCleared.
+    void Resize(int width, int height);
+    void MarkAll();
+    // Half-open bounds, clipped to the target.
+    void MarkDrawn(int x0, int y0, int x1, int y1);
+    // The whole target was overwritten with color.
+    void MarkCleared(Color32 color);
+    // The consumer caught up; damage starts empty again.
+    void Reset();
+
+    const std::vector<PixelRect>& Rects() const { return damage_; }
+    // Drawn since the last MarkCleared.
+    const std::vector<PixelRect>& Drawn() const { return drawn_; }
+    // True when the target holds nothing but the last MarkCleared color, stored in color.
+    bool ClearedTo(Color32* color) const;
+
+  private:
+    static void Add(std::vector<PixelRect>& rects, const PixelRect& rect);
+
+    int width_ = 0;
+    int height_ = 0;
+    // Changed since Reset().
+    std::vector<PixelRect> damage_;
+    // Drawn since the last clear.
+    std::vector<PixelRect> drawn_;
+    bool clear_known_ = false;
+    Color32 clear_color_;
+};
@@ -0,0 +1,301 @@
+#include "engine/render/DepthBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SANDBOX_DEPTH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+constexpr int kBlockShift = 3;
+constexpr int kBlockMask = DepthBuffer::kBlockSize - 1;
+static_assert((1 << kBlockShift) == DepthBuffer::kBlockSize, "kBlockShift must match kBlockSize");
+
+uint16_t ToUnorm16(float z) {
+    z = std::min(std::max(z, 0.0f), 1.0f);
+    return static_cast<uint16_t>(z * 65535.0f + 0.5f);
+}
+} // namespace
+
+bool DepthPlane::FromTriangle(const ScreenVertex& v0, const ScreenVertex& v1,
+                              const ScreenVertex& v2, DepthPlane* out) {
+    const float ax = v1.x - v0.x;
+    const float ay = v1.y - v0.y;
+    const float bx = v2.x - v0.x;
+    const float by = v2.y - v0.y;
+    const float area = ax * by - ay * bx;
+    if (area == 0.0f || !std::isfinite(area)) {
+        return false;
+    }
+    const float az = v1.z - v0.z;
+    const float bz = v2.z - v0.z;
+    out->x0 = v0.x;
+    out->y0 = v0.y;
+    out->z0 = v0.z;
+    out->dzdx = (az * by - bz * ay) / area;
+    out->dzdy = (bz * ax - az * bx) / area;
+    return true;
+}
+
+void DepthBuffer::Resize(int width, int height) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    Allocate();
+}
+
+void DepthBuffer::SetFormat(DepthFormat format) {
+    if (format == format_) {
+        return;
+    }
+    format_ = format;
+    Allocate();
+}
+
+void DepthBuffer::Allocate() {
+    const size_t pixels = static_cast<size_t>(width_) * static_cast<size_t>(height_);
+    depth32_.clear();
+    depth16_.clear();
+    hiz_.clear();
+    dirty_.clear();
+    if (format_ == DepthFormat::None) {
+        depth32_.shrink_to_fit();
+        depth16_.shrink_to_fit();
+        blocks_x_ = 0;
+        blocks_y_ = 0;
+        return;
+    }
+    if (format_ == DepthFormat::Float32) {
+        depth16_.shrink_to_fit();
+        depth32_.assign(pixels, 1.0f);
+    } else {
+        depth32_.shrink_to_fit();
+        depth16_.assign(pixels, 0xFFFFu);
+    }
+    blocks_x_ = (width_ + kBlockMask) >> kBlockShift;
+    blocks_y_ = (height_ + kBlockMask) >> kBlockShift;
+    hiz_.assign(static_cast<size_t>(blocks_x_) * static_cast<size_t>(blocks_y_), 1.0f);
+    dirty_.assign(hiz_.size(), 0);
+}
+
+void DepthBuffer::Clear(float depth) { Clear(depth, 0, 0, width_, height_); }
+
+void DepthBuffer::Clear(float depth, int x0, int y0, int x1, int y1) {
+    if (format_ == DepthFormat::None) {
+        return;
+    }
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, width_);
+    y1 = std::min(y1, height_);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    const size_t count = static_cast<size_t>(x1 - x0);
+    const uint16_t depth16 = ToUnorm16(depth);
+    for (int y = y0; y < y1; ++y) {
+        const size_t row = static_cast<size_t>(y) * width_ + x0;
+        if (format_ == DepthFormat::Float32) {
+            std::fill_n(depth32_.begin() + row, count, depth);
+        } else {
+            std::fill_n(depth16_.begin() + row, count, depth16);
+        }
+    }
+    // Blocks the rect covers completely (or up to the target edge) take the clear depth
+    // directly; partly covered ones are rebuilt.
+    const float stored = format_ == DepthFormat::Float32 ? depth : depth16 / 65535.0f;
+    for (int by = y0 >> kBlockShift; by <= (y1 - 1) >> kBlockShift; ++by) {
+        const int block_y0 = by << kBlockShift;
+        const int block_y1 = std::min(block_y0 + kBlockSize, height_);
+        for (int bx = x0 >> kBlockShift; bx <= (x1 - 1) >> kBlockShift; ++bx) {
+            const int block_x0 = bx << kBlockShift;
+            const int block_x1 = std::min(block_x0 + kBlockSize, width_);
+            const size_t block = static_cast<size_t>(by) * blocks_x_ + bx;
+            if (x0 <= block_x0 && y0 <= block_y0 && x1 >= block_x1 && y1 >= block_y1) {
+                hiz_[block] = stored;
+                dirty_[block] = 0;
+            } else {
+                hiz_[block] = BlockMax(bx, by);
+            }
+        }
+    }
+}
+
+bool DepthBuffer::Occluded(int x0, int y0, int x1, int y1, float min_z) const {
+    if (format_ == DepthFormat::None) {
+        return false;
+    }
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, width_);
+    y1 = std::min(y1, height_);
+    if (x0 >= x1 || y0 >= y1) {
+        return true;
+    }
+    for (int by = y0 >> kBlockShift; by <= (y1 - 1) >> kBlockShift; ++by) {
+        const float* row = hiz_.data() + static_cast<size_t>(by) * blocks_x_;
+        for (int bx = x0 >> kBlockShift; bx <= (x1 - 1) >> kBlockShift; ++bx) {
+            if (min_z < row[bx]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Tests count (at most kBlockSize) pixels starting at index with depth z, z + dzdx, ...
+// Returns the passing pixels as a bit mask.
+unsigned DepthBuffer::TestSegment(size_t index, int count, float z, float dzdx) {
+    unsigned mask = 0;
+    int i = 0;
+    if (format_ == DepthFormat::Float32) {
+        float* depth = depth32_.data() + index;
+#if defined(SANDBOX_DEPTH_SSE2)
+        // Lanes use the same z + dzdx * i as the scalar tail, so depth stays monotonic along
+        // the span and the HiZ end-point test in TestSpan is exact.
+        const __m128 zs = _mm_set1_ps(z);
+        const __m128 dz = _mm_set1_ps(dzdx);
+        __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        for (; i + 4 <= count; i += 4) {
+            const __m128 zv = _mm_add_ps(zs, _mm_mul_ps(dz, lane));
+            const __m128 stored = _mm_loadu_ps(depth + i);
+            const __m128 pass = _mm_cmplt_ps(zv, stored);
+            _mm_storeu_ps(depth + i,
+                          _mm_or_ps(_mm_and_ps(pass, zv), _mm_andnot_ps(pass, stored)));
+            mask |= static_cast<unsigned>(_mm_movemask_ps(pass)) << i;
+            lane = _mm_add_ps(lane, _mm_set1_ps(4.0f));
+        }
+#endif
+        for (; i < count; ++i) {
+            const float zi = z + dzdx * static_cast<float>(i);
+            if (zi < depth[i]) {
+                depth[i] = zi;
+                mask |= 1u << i;
+            }
+        }
+        return mask;
+    }
+    uint16_t* depth = depth16_.data() + index;
+    for (; i < count; ++i) {
+        const uint16_t zi = ToUnorm16(z + dzdx * static_cast<float>(i));
+        if (zi < depth[i]) {
+            depth[i] = zi;
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+void DepthBuffer::TestSpan(const CoverageSpan& span, const DepthPlane& plane,
+                           std::vector<CoverageSpan>& passed) {
+    const int y = span.y;
+    const int end = span.x + span.count;
+    const size_t row = static_cast<size_t>(y) * width_;
+    const size_t block_row = static_cast<size_t>(y >> kBlockShift) * blocks_x_;
+    int run_start = -1;
+    int x = span.x;
+    while (x < end) {
+        const int segment_end = std::min(end, (x | kBlockMask) + 1);
+        const int count = segment_end - x;
+        const size_t block = block_row + (x >> kBlockShift);
+        const float z = plane.At(x, y);
+        const float z_last = z + plane.dzdx * static_cast<float>(count - 1);
+        unsigned mask = 0;
+        // Depth is linear along the span, so its nearest point is one of the ends.
+        if (std::min(z, z_last) < hiz_[block]) {
+            mask = TestSegment(row + x, count, z, plane.dzdx);
+            if (mask) {
+                dirty_[block] = 1;
+            }
+        }
+        const unsigned full = (1u << count) - 1u;
+        if (mask == full) {
+            if (run_start < 0) {
+                run_start = x;
+            }
+            x = segment_end;
+            continue;
+        }
+        if (mask == 0) {
+            if (run_start >= 0) {
+                passed.push_back({y, run_start, x - run_start});
+                run_start = -1;
+            }
+            x = segment_end;
+            continue;
+        }
+        for (int i = 0; i < count; ++i) {
+            const bool pass = (mask >> i) & 1u;
+            if (pass && run_start < 0) {
+                run_start = x + i;
+            } else if (!pass && run_start >= 0) {
+                passed.push_back({y, run_start, x + i - run_start});
+                run_start = -1;
+            }
+        }
+        x = segment_end;
+    }
+    if (run_start >= 0) {
+        passed.push_back({y, run_start, end - run_start});
+    }
+}
+
+float DepthBuffer::BlockMax(int bx, int by) const {
+    const int x0 = bx << kBlockShift;
+    const int y0 = by << kBlockShift;
+    const int x1 = std::min(x0 + kBlockSize, width_);
+    const int y1 = std::min(y0 + kBlockSize, height_);
+    if (format_ == DepthFormat::Float32) {
+#if defined(SANDBOX_DEPTH_SSE2)
+        if (x1 - x0 == kBlockSize) {
+            __m128 result = _mm_setzero_ps();
+            for (int y = y0; y < y1; ++y) {
+                const float* row = depth32_.data() + static_cast<size_t>(y) * width_ + x0;
+                result = _mm_max_ps(result, _mm_max_ps(_mm_loadu_ps(row), _mm_loadu_ps(row + 4)));
+            }
+            result = _mm_max_ps(result, _mm_movehl_ps(result, result));
+            result = _mm_max_ss(result, _mm_shuffle_ps(result, result, 1));
+            return _mm_cvtss_f32(result);
+        }
+#endif
+        float result = 0.0f;
+        for (int y = y0; y < y1; ++y) {
+            const float* row = depth32_.data() + static_cast<size_t>(y) * width_;
+            for (int x = x0; x < x1; ++x) {
+                result = std::max(result, row[x]);
+            }
+        }
+        return result;
+    }
+    uint16_t result = 0;
+    for (int y = y0; y < y1; ++y) {
+        const uint16_t* row = depth16_.data() + static_cast<size_t>(y) * width_;
+        for (int x = x0; x < x1; ++x) {
+            result = std::max(result, row[x]);
+        }
+    }
+    return result / 65535.0f;
+}
+
+void DepthBuffer::RefreshHiZ(int x0, int y0, int x1, int y1) {
+    if (format_ == DepthFormat::None) {
+        return;
+    }
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, width_);
+    y1 = std::min(y1, height_);
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    for (int by = y0 >> kBlockShift; by <= (y1 - 1) >> kBlockShift; ++by) {
+        for (int bx = x0 >> kBlockShift; bx <= (x1 - 1) >> kBlockShift; ++bx) {
+            const size_t block = static_cast<size_t>(by) * blocks_x_ + bx;
+            if (dirty_[block]) {
+                hiz_[block] = BlockMax(bx, by);
+                dirty_[block] = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "engine/core/DepthFormat.h"
+#include "engine/core/ScreenVertex.h"
+#include "engine/render/TriangleRaster.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A triangle's depth as a plane over pixel centers, anchored at its first vertex to keep float
+// error small near the triangle.
+struct DepthPlane {
+    float x0 = 0.0f;
+    float y0 = 0.0f;
+    float z0 = 0.0f;
+    float dzdx = 0.0f;
+    float dzdy = 0.0f;
+
+    // Returns false for degenerate triangles.
+    static bool FromTriangle(const ScreenVertex& v0, const ScreenVertex& v1,
+                             const ScreenVertex& v2, DepthPlane* out);
+    float At(int x, int y) const {
+        return z0 + dzdx * (static_cast<float>(x) + 0.5f - x0) +
+               dzdy * (static_cast<float>(y) + 0.5f - y0);
+    }
+};
+
+// Depth attachment with a hierarchical-Z level: for every 8x8 block it keeps the farthest
+// stored depth, so a fragment run that cannot beat it is dropped without touching the
+// per-pixel values. Block maxima are refreshed lazily from the blocks a draw wrote to.
+//
+// Distinct blocks may be read and written from different threads at once, which lets the
+// binned renderer test each tile on its own worker.
+class DepthBuffer {
+  public:
+    static constexpr int kBlockSize = 8;
+
+    void Resize(int width, int height);
+    // Reallocates the storage; the new buffer is cleared to the far plane.
+    void SetFormat(DepthFormat format);
+    DepthFormat Format() const { return format_; }
+    bool Enabled() const { return format_ != DepthFormat::None; }
+
+    void Clear(float depth);
+    void Clear(float depth, int x0, int y0, int x1, int y1);
+
+    // True when nothing at min_z or farther can pass anywhere in [x0, x1) x [y0, y1).
+    bool Occluded(int x0, int y0, int x1, int y1, float min_z) const;
+    // Tests the pixels of span against the plane, stores the depth of those that pass and
+    // appends the passing runs to passed.
+    void TestSpan(const CoverageSpan& span, const DepthPlane& plane,
+                  std::vector<CoverageSpan>& passed);
+    // Recomputes the block maxima written by TestSpan inside [x0, x1) x [y0, y1).
+    void RefreshHiZ(int x0, int y0, int x1, int y1);
+
+  private:
+    void Allocate();
+    unsigned TestSegment(size_t index, int count, float z, float dzdx);
+    float BlockMax(int bx, int by) const;
+
+    DepthFormat format_ = DepthFormat::None;
+    int width_ = 0;
+    int height_ = 0;
+    int blocks_x_ = 0;
+    int blocks_y_ = 0;
+    std::vector<float> depth32_;
+    std::vector<uint16_t> depth16_;
+    std::vector<float> hiz_;
+    std::vector<uint8_t> dirty_;
+};
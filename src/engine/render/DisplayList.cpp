@@ -0,0 +1,246 @@
+#include "engine/render/DisplayList.h"
+
+#include <algorithm>
+
+void DisplayList::Reset() {
+    commands_.clear();
+    points_.clear();
+    colors_.clear();
+    vertices_.clear();
+    shapes_.clear();
+    lines_.clear();
+    images_.clear();
+    transforms_.clear();
+    depth_format_ = DepthFormat::None;
+    uses_depth_ = false;
+    cached_ = false;
+}
+
+DisplayList::Command& DisplayList::Record(CommandType type, Color32 color, BlendMode blend) {
+    cached_ = false;
+    Command& command = commands_.emplace_back();
+    command.type = type;
+    command.color = color;
+    command.blend = blend;
+    return command;
+}
+
+void DisplayList::Resize(int width, int height) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    cached_ = false;
+}
+
+void DisplayList::Clear(Color32 color) { Record(CommandType::Clear, color, BlendMode::Replace); }
+
+void DisplayList::PutPixel(int x, int y, Color32 color, BlendMode blend) {
+    FillRect(x, y, 1, 1, color, blend);
+}
+
+void DisplayList::PutPixels(const PixelCoord* coords, size_t count, Color32 color,
+                            BlendMode blend) {
+    Command& command = Record(CommandType::Points, color, blend);
+    command.first = points_.size();
+    command.count = count;
+    points_.insert(points_.end(), coords, coords + count);
+}
+
+void DisplayList::PutPixels(const PixelCoord* coords, const Color32* colors, size_t count,
+                            BlendMode blend) {
+    Command& command = Record(CommandType::ColoredPoints, Color32{}, blend);
+    command.first = points_.size();
+    command.count = count;
+    command.colors = colors_.size();
+    points_.insert(points_.end(), coords, coords + count);
+    colors_.insert(colors_.end(), colors, colors + count);
+}
+
+void DisplayList::PutSpan(int x, int y, const Color32* colors, size_t count, BlendMode blend) {
+    Command& command = Record(CommandType::Span, Color32{}, blend);
+    command.x = x;
+    command.y = y;
+    command.first = colors_.size();
+    command.count = count;
+    colors_.insert(colors_.end(), colors, colors + count);
+}
+
+void DisplayList::FillSpan(int x, int y, int width, Color32 color, BlendMode blend) {
+    FillRect(x, y, width, 1, color, blend);
+}
+
+void DisplayList::FillRect(int x, int y, int width, int height, Color32 color, BlendMode blend) {
+    Command& command = Record(CommandType::Rect, color, blend);
+    command.x = x;
+    command.y = y;
+    command.width = width;
+    command.height = height;
+}
+
+void DisplayList::FillTriangle(const ScreenVertex& v0, const ScreenVertex& v1,
+                               const ScreenVertex& v2, Color32 color, BlendMode blend) {
+    Command& command = Record(CommandType::Triangle, color, blend);
+    command.first = vertices_.size();
+    vertices_.push_back(v0);
+    vertices_.push_back(v1);
+    vertices_.push_back(v2);
+}
+
+void DisplayList::FillCircle(float cx, float cy, float radius, Color32 color, BlendMode blend) {
+    Command& command = Record(CommandType::Circle, color, blend);
+    command.first = shapes_.size();
+    shapes_.push_back(Shape{cx, cy, radius, radius});
+}
+
+void DisplayList::FillEllipse(float cx, float cy, float rx, float ry, Color32 color,
+                              BlendMode blend) {
+    Command& command = Record(CommandType::Ellipse, color, blend);
+    command.first = shapes_.size();
+    shapes_.push_back(Shape{cx, cy, rx, ry});
+}
+
+void DisplayList::StrokeRing(float cx, float cy, float inner_radius, float outer_radius,
+                             Color32 color, BlendMode blend) {
+    Command& command = Record(CommandType::Ring, color, blend);
+    command.first = shapes_.size();
+    shapes_.push_back(Shape{cx, cy, inner_radius, outer_radius});
+}
+
+void DisplayList::DrawLine(const LineSegment& line, Color32 color, BlendMode blend,
+                           LineMode mode) {
+    DrawLines(&line, 1, color, blend, mode);
+}
+
+void DisplayList::DrawLines(const LineSegment* lines, size_t count, Color32 color,
+                            BlendMode blend, LineMode mode) {
+    Command& command = Record(CommandType::Lines, color, blend);
+    command.line_mode = mode;
+    command.first = lines_.size();
+    command.count = count;
+    lines_.insert(lines_.end(), lines, lines + count);
+}
+
+void DisplayList::BlitTransformed(const Image& image, const ImageTransform& transform,
+                                  ImageFilter filter, BlendMode blend) {
+    Command& command = Record(CommandType::Image, Color32{}, blend);
+    command.filter = filter;
+    command.first = images_.size();
+    images_.push_back(image);
+    transforms_.push_back(transform);
+}
+
+void DisplayList::SetDepthFormat(DepthFormat format) {
+    Command& command = Record(CommandType::DepthFormat, Color32{}, BlendMode::Replace);
+    command.depth_format = format;
+    depth_format_ = format;
+    uses_depth_ = true;
+}
+
+void DisplayList::ClearDepth(float depth) {
+    Command& command = Record(CommandType::DepthClear, Color32{}, BlendMode::Replace);
+    command.depth = depth;
+    uses_depth_ = true;
+}
+
+void DisplayList::Replay(IRenderer& target) const {
+    for (const Command& command : commands_) {
+        switch (command.type) {
+        case CommandType::Clear:
+            target.Clear(command.color);
+            break;
+        case CommandType::Points:
+            target.PutPixels(points_.data() + command.first, command.count, command.color,
+                             command.blend);
+            break;
+        case CommandType::ColoredPoints:
+            target.PutPixels(points_.data() + command.first, colors_.data() + command.colors,
+                             command.count, command.blend);
+            break;
+        case CommandType::Span:
+            target.PutSpan(command.x, command.y, colors_.data() + command.first, command.count,
+                           command.blend);
+            break;
+        case CommandType::Rect:
+            target.FillRect(command.x, command.y, command.width, command.height, command.color,
+                            command.blend);
+            break;
+        case CommandType::Triangle: {
+            const ScreenVertex* v = vertices_.data() + command.first;
+            target.FillTriangle(v[0], v[1], v[2], command.color, command.blend);
+            break;
+        }
+        case CommandType::Circle: {
+            const Shape& shape = shapes_[command.first];
+            target.FillCircle(shape.cx, shape.cy, shape.rx, command.color, command.blend);
+            break;
+        }
+        case CommandType::Ellipse: {
+            const Shape& shape = shapes_[command.first];
+            target.FillEllipse(shape.cx, shape.cy, shape.rx, shape.ry, command.color,
+                               command.blend);
+            break;
+        }
+        case CommandType::Ring: {
+            const Shape& shape = shapes_[command.first];
+            target.StrokeRing(shape.cx, shape.cy, shape.rx, shape.ry, command.color,
+                              command.blend);
+            break;
+        }
+        case CommandType::Lines:
+            target.DrawLines(lines_.data() + command.first, command.count, command.color,
+                             command.blend, command.line_mode);
+            break;
+        case CommandType::Image:
+            target.BlitTransformed(images_[command.first], transforms_[command.first],
+                                   command.filter, command.blend);
+            break;
+        case CommandType::DepthFormat:
+            target.SetDepthFormat(command.depth_format);
+            break;
+        case CommandType::DepthClear:
+            target.ClearDepth(command.depth);
+            break;
+        }
+    }
+}
+
+void DisplayList::Draw(IRenderer& target) const {
+    Color32 background;
+    if (uses_depth_ || target.Width() != width_ || target.Height() != height_ ||
+        !target.ClearedTo(&background)) {
+        Replay(target);
+        return;
+    }
+    if (!cached_ || background != background_) {
+        Rasterize(background);
+    }
+    for (const Patch& patch : patches_) {
+        target.Blit(patch.image, patch.x, patch.y);
+    }
+}
+
+const uint8_t* DisplayList::Pixels() const {
+    if (!cached_) {
+        Rasterize(background_);
+    }
+    return cache_.Pixels();
+}
+
+void DisplayList::Rasterize(Color32 background) const {
+    cache_.Resize(width_, height_);
+    cache_.Clear(background);
+    // Damage then holds exactly what the commands draw over the background.
+    cache_.ResetDamage();
+    Replay(cache_);
+
+    const Color32* pixels = reinterpret_cast<const Color32*>(cache_.Pixels());
+    const size_t pitch = static_cast<size_t>(cache_.Pitch());
+    patches_.clear();
+    for (const PixelRect& rect : cache_.Damage()) {
+        const Color32* origin =
+            pixels + static_cast<size_t>(rect.y) * pitch + static_cast<size_t>(rect.x);
+        patches_.push_back(Patch{rect.x, rect.y,
+                                 Image(rect.width, rect.height, origin, cache_.Pitch())});
+    }
+    background_ = background;
+    cached_ = true;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "engine/core/IRenderer.h"
+#include "engine/render/PixelRenderer.h"
+
+#include <cstdint>
+#include <vector>
+
+// Retained draw calls. A scene records into the list like into any renderer, keeps it while its
+// output stays the same, and draws it every frame with Draw. The list rasterizes itself once
+// per background into its own target, so drawing it onto a freshly cleared target of the same
+// size copies the regions it covers instead of replaying every call.
+class DisplayList : public IRenderer {
+  public:
+    // Drops the recorded calls; the size is kept.
+    void Reset();
+    bool Empty() const { return commands_.empty(); }
+
+    // Issues the recorded calls to target in order.
+    void Replay(IRenderer& target) const;
+    // Same result as Replay. When target is Width() x Height() and holds nothing but a clear,
+    // the cached rasterization over that clear color is copied in; lists that use depth, and
+    // other targets, are replayed.
+    void Draw(IRenderer& target) const;
+
+    // Sets the size the list is rasterized at; recorded calls keep their coordinates.
+    void Resize(int width, int height) override;
+    void Clear(Color32 color) override;
+    void PutPixel(int x, int y, Color32 color, BlendMode blend = BlendMode::Replace) override;
+    void PutPixels(const PixelCoord* coords, size_t count, Color32 color,
+                   BlendMode blend = BlendMode::Replace) override;
+    void PutPixels(const PixelCoord* coords, const Color32* colors, size_t count,
+                   BlendMode blend = BlendMode::Replace) override;
+    void PutSpan(int x, int y, const Color32* colors, size_t count,
+                 BlendMode blend = BlendMode::Replace) override;
+    void FillSpan(int x, int y, int width, Color32 color,
+                  BlendMode blend = BlendMode::Replace) override;
+    void FillRect(int x, int y, int width, int height, Color32 color,
+                  BlendMode blend = BlendMode::Replace) override;
+    void FillTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2,
+                      Color32 color, BlendMode blend = BlendMode::Replace) override;
+    void FillCircle(float cx, float cy, float radius, Color32 color,
+                    BlendMode blend = BlendMode::Replace) override;
+    void FillEllipse(float cx, float cy, float rx, float ry, Color32 color,
+                     BlendMode blend = BlendMode::Replace) override;
+    void StrokeRing(float cx, float cy, float inner_radius, float outer_radius, Color32 color,
+                    BlendMode blend = BlendMode::Replace) override;
+    void DrawLine(const LineSegment& line, Color32 color, BlendMode blend = BlendMode::Replace,
+                  LineMode mode = LineMode::Aliased) override;
+    void DrawLines(const LineSegment* lines, size_t count, Color32 color,
+                   BlendMode blend = BlendMode::Replace,
+                   LineMode mode = LineMode::Aliased) override;
+    void BlitTransformed(const Image& image, const ImageTransform& transform,
+                         ImageFilter filter = ImageFilter::Bilinear,
+                         BlendMode blend = BlendMode::Replace) override;
+
+    void SetDepthFormat(DepthFormat format) override;
+    DepthFormat GetDepthFormat() const override { return depth_format_; }
+    void ClearDepth(float depth = 1.0f) override;
+
+    int Width() const override { return width_; }
+    int Height() const override { return height_; }
+    // The list rasterized over the background of the last cached Draw, black before one.
+    const uint8_t* Pixels() const override;
+    int Pitch() const override { return cache_.Pitch(); }
+    // The regions the list draws, once rasterized.
+    const std::vector<PixelRect>& Damage() const override { return cache_.Damage(); }
+    void ResetDamage() override {}
+
+  private:
+    enum class CommandType : uint8_t {
+        Clear,
+        Points,
+        ColoredPoints,
+        Span,
+        Rect,
+        Triangle,
+        Circle,
+        Ellipse,
+        Ring,
+        Lines,
+        Image,
+        DepthFormat,
+        DepthClear,
+    };
+
+    struct Command {
+        CommandType type = CommandType::Rect;
+        BlendMode blend = BlendMode::Replace;
+        LineMode line_mode = LineMode::Aliased;
+        ImageFilter filter = ImageFilter::Bilinear;
+        DepthFormat depth_format = DepthFormat::None;
+        Color32 color;
+        // Rect and the start of a Span.
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        // The command's run in the array its type reads: points_, colors_ for Span, vertices_,
+        // shapes_, lines_, or images_ and transforms_.
+        size_t first = 0;
+        size_t count = 0;
+        // Index of the first color in colors_ for ColoredPoints.
+        size_t colors = 0;
+        float depth = 1.0f;
+    };
+
+    // Circles use rx alone; rings use rx and ry as the inner and outer radius.
+    struct Shape {
+        float cx = 0.0f;
+        float cy = 0.0f;
+        float rx = 0.0f;
+        float ry = 0.0f;
+    };
+
+    // A covered region of the cached rasterization, ready to blit.
+    struct Patch {
+        int x = 0;
+        int y = 0;
+        Image image;
+    };
+
+    Command& Record(CommandType type, Color32 color, BlendMode blend);
+    void Rasterize(Color32 background) const;
+
+    int width_ = 0;
+    int height_ = 0;
+    DepthFormat depth_format_ = DepthFormat::None;
+    bool uses_depth_ = false;
+
+    std::vector<Command> commands_;
+    std::vector<PixelCoord> points_;
+    std::vector<Color32> colors_;
+    std::vector<ScreenVertex> vertices_;
+    std::vector<Shape> shapes_;
+    std::vector<LineSegment> lines_;
+    std::vector<Image> images_;
+    std::vector<ImageTransform> transforms_;
+
+    // Rasterization of the current commands over background_, valid while cached_ is set.
+    mutable PixelRenderer cache_{0, 0};
+    mutable std::vector<Patch> patches_;
+    mutable Color32 background_;
+    mutable bool cached_ = false;
+};
@@ -0,0 +1,35 @@
+#include "engine/render/FramebufferAllocator.h"
+
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+size_t BlockAlignment(size_t bytes) {
+    return bytes >= kHugePageBytes ? kHugePageBytes : kFramebufferAlignment;
+}
+
+size_t RoundUp(size_t bytes, size_t alignment) {
+    return (bytes + alignment - 1) & ~(alignment - 1);
+}
+} // namespace
+
+void* AllocateFramebuffer(size_t bytes) {
+    const size_t alignment = BlockAlignment(bytes);
+    // Rounding the size to whole huge pages lets the last one be backed by a huge page too.
+    const size_t size = RoundUp(bytes, alignment);
+    void* block = ::operator new(size, std::align_val_t(alignment));
+#if defined(__linux__)
+    if (alignment == kHugePageBytes) {
+        // Only a hint: without THP support the block stays on regular pages.
+        madvise(block, size, MADV_HUGEPAGE);
+    }
+#endif
+    return block;
+}
+
+void FreeFramebuffer(void* block, size_t bytes) {
+    ::operator delete(block, std::align_val_t(BlockAlignment(bytes)));
+}
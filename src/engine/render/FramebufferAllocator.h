@@ -0,0 +1,39 @@
+#pragma once
+
+#include "engine/core/Color32.h"
+
+#include <cstddef>
+#include <vector>
+
+// Storage for render targets. Blocks start on a cache line, which is also the widest vector
+// store the span kernels issue, and rows padded to PaddedPitch() keep every row start there
+// too. On Linux, blocks of at least kHugePageBytes start on a huge-page boundary and are
+// advised for transparent huge pages, so a 4K or 8K target spans a few dozen TLB entries
+// instead of thousands of 4 KB pages.
+constexpr size_t kFramebufferAlignment = 64;
+constexpr size_t kHugePageBytes = size_t{2} << 20;
+
+void* AllocateFramebuffer(size_t bytes);
+void FreeFramebuffer(void* block, size_t bytes);
+
+// Smallest row length in pixels that is at least width and keeps rows kFramebufferAlignment
+// apart.
+inline int PaddedPitch(int width) {
+    constexpr int kRowPixels = static_cast<int>(kFramebufferAlignment / sizeof(Color32));
+    return (width + kRowPixels - 1) & ~(kRowPixels - 1);
+}
+
+template <typename T> struct FramebufferAllocator {
+    using value_type = T;
+
+    FramebufferAllocator() = default;
+    template <typename U> FramebufferAllocator(const FramebufferAllocator<U>&) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(AllocateFramebuffer(count * sizeof(T))); }
+    void deallocate(T* block, size_t count) { FreeFramebuffer(block, count * sizeof(T)); }
+
+    template <typename U> bool operator==(const FramebufferAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const FramebufferAllocator<U>&) const { return false; }
+};
+
+template <typename T> using FramebufferVector = std::vector<T, FramebufferAllocator<T>>;
@@ -0,0 +1,188 @@
+#include "engine/render/ImageBlit.h"
+
+#include "engine/render/PixelKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// Rounds a target coordinate to a pixel index clamped to [0, limit]; huge or non-finite values
+// from extreme transforms clamp instead of overflowing the int conversion.
+int ClampToPixel(float value, int limit) {
+    if (!(value > 0.0f)) {
+        return 0;
+    }
+    return value < static_cast<float>(limit) ? static_cast<int>(value) : limit;
+}
+} // namespace
+
+bool ImageBlit::Setup(const Image& image, const ImageTransform& transform, int width,
+                      int height) {
+    if (image.Empty() || width <= 0 || height <= 0) {
+        return false;
+    }
+    const float det = transform.xx * transform.yy - transform.xy * transform.yx;
+    if (det == 0.0f || !std::isfinite(det)) {
+        return false;
+    }
+    image_width_ = image.Width();
+    image_height_ = image.Height();
+
+    // Invert the transform and fold in the half-pixel offset of pixel centers.
+    ux_ = transform.yy / det;
+    uy_ = -transform.xy / det;
+    vx_ = -transform.yx / det;
+    vy_ = transform.xx / det;
+    u0_ = (0.5f - transform.tx) * ux_ + (0.5f - transform.ty) * uy_;
+    v0_ = (0.5f - transform.tx) * vx_ + (0.5f - transform.ty) * vy_;
+
+    const float w = static_cast<float>(image_width_);
+    const float h = static_cast<float>(image_height_);
+    const float xs[4] = {0.0f, transform.xx * w, transform.xy * h,
+                         transform.xx * w + transform.xy * h};
+    const float ys[4] = {0.0f, transform.yx * w, transform.yy * h,
+                         transform.yx * w + transform.yy * h};
+    const float min_x = transform.tx + *std::min_element(xs, xs + 4);
+    const float max_x = transform.tx + *std::max_element(xs, xs + 4);
+    const float min_y = transform.ty + *std::min_element(ys, ys + 4);
+    const float max_y = transform.ty + *std::max_element(ys, ys + 4);
+    int x0 = ClampToPixel(std::floor(min_x), width);
+    int x1 = ClampToPixel(std::ceil(max_x), width);
+    int y0 = ClampToPixel(std::floor(min_y), height);
+    int y1 = ClampToPixel(std::ceil(max_y), height);
+
+    axis_aligned_ = transform.xy == 0.0f && transform.yx == 0.0f;
+    if (axis_aligned_) {
+        // u depends only on x and v only on y here, so trimming the edge columns and rows whose
+        // centers fall outside leaves exactly the pixels RowSpan would report.
+        auto column_inside = [this, w](int x) {
+            const float u = u0_ + ux_ * static_cast<float>(x);
+            return u >= 0.0f && u < w;
+        };
+        auto row_inside = [this, h](int y) {
+            const float v = v0_ + vy_ * static_cast<float>(y);
+            return v >= 0.0f && v < h;
+        };
+        while (x0 < x1 && !column_inside(x0)) {
+            ++x0;
+        }
+        while (x1 > x0 && !column_inside(x1 - 1)) {
+            --x1;
+        }
+        while (y0 < y1 && !row_inside(y0)) {
+            ++y0;
+        }
+        while (y1 > y0 && !row_inside(y1 - 1)) {
+            --y1;
+        }
+    }
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+    bounds_ = PixelRect{x0, y0, x1 - x0, y1 - y0};
+
+    copy_ = transform.xx == 1.0f && transform.yy == 1.0f && axis_aligned_ &&
+            transform.tx == std::floor(transform.tx) && transform.ty == std::floor(transform.ty);
+    if (copy_) {
+        copy_x_ = static_cast<int>(transform.tx);
+        copy_y_ = static_cast<int>(transform.ty);
+    }
+    return true;
+}
+
+bool ImageBlit::Inside(int x, int y) const {
+    const float fx = static_cast<float>(x);
+    const float fy = static_cast<float>(y);
+    // Same grouping as the sampling kernels: the row origin first, then the step along x.
+    const float u = (u0_ + uy_ * fy) + ux_ * fx;
+    const float v = (v0_ + vy_ * fy) + vx_ * fx;
+    return u >= 0.0f && u < static_cast<float>(image_width_) && v >= 0.0f &&
+           v < static_cast<float>(image_height_);
+}
+
+bool ImageBlit::RowSpan(int y, int clip_x0, int clip_x1, int* x0, int* x1) const {
+    if (y < bounds_.y || y >= bounds_.y + bounds_.height) {
+        return false;
+    }
+    const int lo = std::max(clip_x0, bounds_.x);
+    const int hi = std::min(clip_x1, bounds_.x + bounds_.width);
+    if (lo >= hi) {
+        return false;
+    }
+    if (axis_aligned_) {
+        *x0 = lo;
+        *x1 = hi;
+        return true;
+    }
+
+    // Along the row, u and v are linear in x; intersect the ranges keeping each in the image.
+    float begin = static_cast<float>(lo);
+    float end = static_cast<float>(hi);
+    const float fy = static_cast<float>(y);
+    const float origins[2] = {u0_ + uy_ * fy, v0_ + vy_ * fy};
+    const float slopes[2] = {ux_, vx_};
+    const float limits[2] = {static_cast<float>(image_width_), static_cast<float>(image_height_)};
+    for (int axis = 0; axis < 2; ++axis) {
+        const float origin = origins[axis];
+        const float slope = slopes[axis];
+        if (slope == 0.0f) {
+            if (!(origin >= 0.0f && origin < limits[axis])) {
+                return false;
+            }
+            continue;
+        }
+        float enter = -origin / slope;
+        float leave = (limits[axis] - origin) / slope;
+        if (slope < 0.0f) {
+            std::swap(enter, leave);
+        }
+        begin = std::max(begin, std::ceil(enter));
+        end = std::min(end, std::ceil(leave));
+    }
+    if (!(begin < end)) {
+        begin = end = static_cast<float>(lo);
+    }
+    // The divisions round, so settle the ends with the same arithmetic Inside uses.
+    int start = static_cast<int>(begin);
+    int stop = static_cast<int>(end);
+    while (start < stop && !Inside(start, y)) {
+        ++start;
+    }
+    while (stop > start && !Inside(stop - 1, y)) {
+        --stop;
+    }
+    if (start < stop) {
+        while (start > lo && Inside(start - 1, y)) {
+            --start;
+        }
+        while (stop < hi && Inside(stop, y)) {
+            ++stop;
+        }
+    }
+    *x0 = start;
+    *x1 = stop;
+    return start < stop;
+}
+
+void ImageBlit::Sample(const Image& image, ImageFilter filter, int x, int y, Color32* dst,
+                       size_t count) const {
+    if (copy_) {
+        const int sx = x - copy_x_;
+        const uint32_t row = image.RowOffsets()[y - copy_y_];
+        const Color32* texels = image.Texels();
+        if (image.Layout() == ImageLayout::Linear) {
+            std::memcpy(dst, texels + row + sx, count * sizeof(Color32));
+            return;
+        }
+        const uint32_t* columns = image.ColumnOffsets() + sx;
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = texels[row + columns[i]];
+        }
+        return;
+    }
+    // Sample from the row origin so every split of a row (tiles, bins) reads the same texels.
+    const float fy = static_cast<float>(y);
+    SampleImage(image, filter, u0_ + uy_ * fy, v0_ + vy_ * fy, ux_, vx_, static_cast<size_t>(x),
+                dst, count);
+}
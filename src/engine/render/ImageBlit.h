@@ -0,0 +1,50 @@
+#pragma once
+
+#include "engine/core/Image.h"
+#include "engine/core/PixelRect.h"
+
+#include <cstddef>
+
+// Target-side setup of one image draw, shared by the renderers: the clipped bounds it covers,
+// the columns of each row whose pixel centers land inside the image, and the image coordinates
+// those centers sample. It only keeps the image's size, so a deferred draw can pair it with its
+// own copy of the image.
+class ImageBlit {
+  public:
+    // False when nothing is drawn: an empty image, a degenerate transform, or an image entirely
+    // outside the width x height target.
+    bool Setup(const Image& image, const ImageTransform& transform, int width, int height);
+
+    // Every drawn pixel lies inside Bounds().
+    const PixelRect& Bounds() const { return bounds_; }
+    // True for an axis-aligned draw, whose bounds are exactly the pixels drawn; opaque draws can
+    // then skip clears owed inside them.
+    bool CoversBounds() const { return axis_aligned_; }
+
+    // Columns [*x0, *x1) of row y, within [clip_x0, clip_x1), whose centers map into the image.
+    // False when there are none.
+    bool RowSpan(int y, int clip_x0, int clip_x1, int* x0, int* x1) const;
+    // Samples pixels [x, x + count) of row y, which should come from RowSpan.
+    void Sample(const Image& image, ImageFilter filter, int x, int y, Color32* dst,
+                size_t count) const;
+
+  private:
+    bool Inside(int x, int y) const;
+
+    int image_width_ = 0;
+    int image_height_ = 0;
+    // Image coordinates of the center of target pixel (x, y): (u0_ + ux_ * x + uy_ * y,
+    // v0_ + vx_ * x + vy_ * y).
+    float u0_ = 0.0f;
+    float ux_ = 0.0f;
+    float uy_ = 0.0f;
+    float v0_ = 0.0f;
+    float vx_ = 0.0f;
+    float vy_ = 0.0f;
+    PixelRect bounds_;
+    bool axis_aligned_ = false;
+    // A whole-pixel translation at unit scale: rows are copied instead of sampled.
+    bool copy_ = false;
+    int copy_x_ = 0;
+    int copy_y_ = 0;
+};
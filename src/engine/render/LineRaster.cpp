@@ -0,0 +1,228 @@
+#include "engine/render/LineRaster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+// Endpoints are clipped slightly outside the target so the pixels next to its edges keep their
+// neighbours' slope; antialiased lines reach one pixel further on each side.
+constexpr double kAliasedGuard = 1.0;
+constexpr double kAntialiasedGuard = 2.0;
+
+// Liang-Barsky against target grown by guard. Computed in double so distant endpoints keep the
+// visible part's slope.
+bool ClipSegment(const LineSegment& line, const RasterClip& target, double guard,
+                 LineSegment* out) {
+    if (target.x0 >= target.x1 || target.y0 >= target.y1) {
+        return false;
+    }
+    const double x0 = line.x0;
+    const double y0 = line.y0;
+    const double dx = static_cast<double>(line.x1) - x0;
+    const double dy = static_cast<double>(line.y1) - y0;
+    if (!std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(dx) || !std::isfinite(dy)) {
+        return false;
+    }
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {x0 - (target.x0 - guard), (target.x1 + guard) - x0,
+                         y0 - (target.y0 - guard), (target.y1 + guard) - y0};
+    double t0 = 0.0;
+    double t1 = 1.0;
+    for (int edge = 0; edge < 4; ++edge) {
+        if (p[edge] == 0.0) {
+            if (q[edge] < 0.0) {
+                return false;
+            }
+            continue;
+        }
+        const double t = q[edge] / p[edge];
+        if (p[edge] < 0.0) {
+            if (t > t1) {
+                return false;
+            }
+            t0 = std::max(t0, t);
+        } else {
+            if (t < t0) {
+                return false;
+            }
+            t1 = std::min(t1, t);
+        }
+    }
+    out->x0 = static_cast<float>(x0 + t0 * dx);
+    out->y0 = static_cast<float>(y0 + t0 * dy);
+    out->x1 = static_cast<float>(x0 + t1 * dx);
+    out->y1 = static_cast<float>(y0 + t1 * dy);
+    return true;
+}
+
+// Without SSE4.1, std::floor is a library call; clipped coordinates always fit in an int.
+int FloorToInt(float v) {
+    const int i = static_cast<int>(v);
+    return v < static_cast<float>(i) ? i - 1 : i;
+}
+} // namespace
+
+bool ClipLine(const LineSegment& line, LineMode mode, const RasterClip& target,
+              LineSegment* out) {
+    return ClipSegment(line, target,
+                       mode == LineMode::Antialiased ? kAntialiasedGuard : kAliasedGuard, out);
+}
+
+void RasterizeLine(const LineSegment& line, const RasterClip& target, const RasterClip& clip,
+                   std::vector<CoverageSpan>& spans) {
+    LineSegment clipped;
+    if (!ClipSegment(line, target, kAliasedGuard, &clipped)) {
+        return;
+    }
+    const int x0 = FloorToInt(clipped.x0);
+    const int y0 = FloorToInt(clipped.y0);
+    const int dx = FloorToInt(clipped.x1) - x0;
+    const int dy = FloorToInt(clipped.y1) - y0;
+    // Walk in (major, minor) coordinates so one loop serves both orientations.
+    const bool x_major = std::abs(dx) >= std::abs(dy);
+    const int major0 = x_major ? x0 : y0;
+    const int minor0 = x_major ? y0 : x0;
+    const int major_delta = x_major ? dx : dy;
+    const int minor_delta = x_major ? dy : dx;
+    const int major_step = major_delta < 0 ? -1 : 1;
+    const int minor_step = minor_delta < 0 ? -1 : 1;
+    const int64_t major_len = std::abs(major_delta);
+    const int64_t minor_len = std::abs(minor_delta);
+    const int clip_major0 = x_major ? clip.x0 : clip.y0;
+    const int clip_major1 = x_major ? clip.x1 : clip.y1;
+    const int clip_minor0 = x_major ? clip.y0 : clip.x0;
+    const int clip_minor1 = x_major ? clip.y1 : clip.x1;
+
+    // Step i in [0, major_len] visits major0 + major_step * i; keep the ones inside clip.
+    int64_t first = 0;
+    int64_t last = 0;
+    if (major_step > 0) {
+        first = std::max<int64_t>(0, int64_t{clip_major0} - major0);
+        last = std::min<int64_t>(major_len, int64_t{clip_major1} - 1 - major0);
+    } else {
+        first = std::max<int64_t>(0, int64_t{major0} - (clip_major1 - 1));
+        last = std::min<int64_t>(major_len, int64_t{major0} - clip_major0);
+    }
+    if (first > last) {
+        return;
+    }
+
+    // The minor offset at step i is i * minor_len / major_len rounded half up. It is computed
+    // directly for the first visible step and then carried as a Bresenham error term.
+    const int64_t denominator = 2 * major_len;
+    const int64_t increment = 2 * minor_len;
+    const int64_t numerator = 2 * first * minor_len + major_len;
+    int64_t offset = denominator > 0 ? numerator / denominator : 0;
+    int64_t error = denominator > 0 ? numerator % denominator : 0;
+    if (!x_major) {
+        // At most one pixel per row.
+        for (int64_t i = first; i <= last; ++i) {
+            const int x = minor0 + minor_step * static_cast<int>(offset);
+            if (x >= clip_minor0 && x < clip_minor1) {
+                spans.push_back({major0 + major_step * static_cast<int>(i), x, 1});
+            }
+            error += increment;
+            if (error >= denominator) {
+                error -= denominator;
+                ++offset;
+            }
+        }
+        return;
+    }
+    // Row by row: the steps left on the current row follow from the error term.
+    for (int64_t i = first; i <= last;) {
+        int64_t run = last - i + 1;
+        if (increment > 0) {
+            run = std::min(run, (denominator - error + increment - 1) / increment);
+        }
+        const int y = minor0 + minor_step * static_cast<int>(offset);
+        if (y >= clip_minor0 && y < clip_minor1) {
+            const int start = major0 + major_step * static_cast<int>(i);
+            const int x = major_step > 0 ? start : start - static_cast<int>(run - 1);
+            spans.push_back({y, x, static_cast<int>(run)});
+        }
+        i += run;
+        error += run * increment;
+        if (error >= denominator) {
+            error -= denominator;
+            ++offset;
+        }
+    }
+}
+
+void RasterizeLineAA(const LineSegment& line, const RasterClip& target, const RasterClip& clip,
+                     std::vector<CoveragePixel>& pixels) {
+    LineSegment clipped;
+    if (!ClipSegment(line, target, kAntialiasedGuard, &clipped)) {
+        return;
+    }
+    // Shift so pixel (x, y) is centered on the integer point.
+    float x0 = clipped.x0 - 0.5f;
+    float y0 = clipped.y0 - 0.5f;
+    float x1 = clipped.x1 - 0.5f;
+    float y1 = clipped.y1 - 0.5f;
+    const bool steep = std::fabs(y1 - y0) > std::fabs(x1 - x0);
+    if (steep) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    const float gradient = x1 > x0 ? (y1 - y0) / (x1 - x0) : 0.0f;
+    const int clip_major0 = steep ? clip.y0 : clip.x0;
+    const int clip_major1 = steep ? clip.y1 : clip.x1;
+    const int clip_minor0 = steep ? clip.x0 : clip.y0;
+    const int clip_minor1 = steep ? clip.x1 : clip.y1;
+
+    const auto plot = [&](int major, int minor, float coverage) {
+        if (major < clip_major0 || major >= clip_major1 || minor < clip_minor0 ||
+            minor >= clip_minor1) {
+            return;
+        }
+        const int value = std::min(255, static_cast<int>(coverage * 255.0f + 0.5f));
+        if (value <= 0) {
+            return;
+        }
+        // Fields are written in place; building a temporary first makes the copy stall on
+        // store forwarding.
+        CoveragePixel& pixel = pixels.emplace_back();
+        pixel.x = steep ? minor : major;
+        pixel.y = steep ? major : minor;
+        pixel.coverage = static_cast<uint8_t>(value);
+    };
+    // Splits weight between the two pixels straddling minor coordinate y.
+    const auto plot_pair = [&](int major, float y, float weight) {
+        const int base = FloorToInt(y);
+        const float frac = y - static_cast<float>(base);
+        plot(major, base, (1.0f - frac) * weight);
+        plot(major, base + 1, frac * weight);
+    };
+
+    // End columns are weighted by how much of them the segment spans.
+    const int major_first = FloorToInt(x0 + 0.5f);
+    const int major_last = FloorToInt(x1 + 0.5f);
+    const float end0 = static_cast<float>(major_first);
+    const float end1 = static_cast<float>(major_last);
+    if (major_first == major_last) {
+        plot_pair(major_first, 0.5f * (y0 + y1), x1 - x0);
+        return;
+    }
+    plot_pair(major_first, y0 + gradient * (end0 - x0), end0 + 0.5f - x0);
+    plot_pair(major_last, y1 + gradient * (end1 - x1), x1 - (end1 - 0.5f));
+
+    // Interior columns; y is evaluated per column rather than accumulated so every clip rect
+    // sees the same values.
+    const int begin = std::max(major_first + 1, clip_major0);
+    const int end = std::min(major_last, clip_major1);
+    if (begin < end) {
+        pixels.reserve(pixels.size() + 2 * static_cast<size_t>(end - begin));
+    }
+    for (int major = begin; major < end; ++major) {
+        plot_pair(major, y0 + gradient * (static_cast<float>(major) - x0), 1.0f);
+    }
+}
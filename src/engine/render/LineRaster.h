@@ -0,0 +1,26 @@
+#pragma once
+
+#include "engine/core/LineMode.h"
+#include "engine/core/LineSegment.h"
+#include "engine/render/RasterCoverage.h"
+
+#include <vector>
+
+// Line rasterizers. The segment is first clipped (Liang-Barsky) to target plus a small guard
+// band, so off-screen parts cost nothing; only pixels inside clip, which must lie within target,
+// are emitted. The clipped segment depends on target alone, so rasterizing one line tile by tile
+// with the same target reproduces the whole-target result exactly.
+
+// The segment the rasterizers draw for line: clipped to target plus the guard band for mode.
+// False when the line misses the target.
+bool ClipLine(const LineSegment& line, LineMode mode, const RasterClip& target,
+              LineSegment* out);
+
+// Bresenham: one pixel per major-axis step, appended as horizontal runs.
+void RasterizeLine(const LineSegment& line, const RasterClip& target, const RasterClip& clip,
+                   std::vector<CoverageSpan>& spans);
+
+// Wu: two pixels per major-axis step weighted by distance to the line, with fractional end
+// points. Zero-coverage pixels are skipped.
+void RasterizeLineAA(const LineSegment& line, const RasterClip& target, const RasterClip& clip,
+                     std::vector<CoveragePixel>& pixels);
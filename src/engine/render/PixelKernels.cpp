@@ -0,0 +1,873 @@
+#include "engine/render/PixelKernels.h"
+
+#include <cstdint>
+#include <cstring>
+
+// SSE2 is baseline on x86-64; other targets use the scalar kernels.
+#if defined(__x86_64__) || defined(_M_X64)
+#define SANDBOX_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SANDBOX_TARGET_AVX2
+#else
+#define SANDBOX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+using FillFn = void (*)(Color32* dst, size_t count, Color32 color);
+using BlendFillFn = void (*)(Color32* dst, size_t count, Color32 color, BlendMode mode);
+using BlendSpanFn = void (*)(Color32* dst, const Color32* src, size_t count, BlendMode mode);
+using ConvertFn = void (*)(const Color4f* src, Color32* dst, size_t count);
+struct SampleSetup;
+using SampleFn = void (*)(const SampleSetup& setup, float u, float v, float du, float dv,
+                          size_t first, Color32* dst, size_t count);
+
+// Linear-to-sRGB encode after Fabian Giesen's fp32 -> sRGB8 conversion. Inputs are clamped to
+// [2^-13, 1 - ulp]; bits 20-29 of the float (the exponent and top mantissa bits) pick an entry,
+// which holds a bias in the high half and a slope in the low half for interpolating on the next
+// eight mantissa bits.
+constexpr float kSrgbMin = 0x1p-13f;
+constexpr float kSrgbAlmostOne = 0x1.fffffep-1f;
+constexpr uint32_t kSrgbMinBits = (127u - 13u) << 23;
+constexpr uint32_t kSrgbTable[104] = {
+    0x0073000d, 0x007a000d, 0x0080000d, 0x0087000d, 0x008d000d, 0x0094000d, 0x009a000d,
+    0x00a1000d, 0x00a7001a, 0x00b4001a, 0x00c1001a, 0x00ce001a, 0x00da001a, 0x00e7001a,
+    0x00f4001a, 0x0101001a, 0x010e0033, 0x01280033, 0x01410033, 0x015b0033, 0x01750033,
+    0x018f0033, 0x01a80033, 0x01c20033, 0x01dc0067, 0x020f0067, 0x02430067, 0x02760067,
+    0x02aa0067, 0x02dd0067, 0x03110067, 0x03440067, 0x037800ce, 0x03df00ce, 0x044600ce,
+    0x04ad00ce, 0x051400ce, 0x057b00c5, 0x05dd00bc, 0x063b00b5, 0x06970158, 0x07420142,
+    0x07e30130, 0x087b0120, 0x090b0112, 0x09940106, 0x0a1700fc, 0x0a9500f2, 0x0b0f01cb,
+    0x0bf401ae, 0x0ccb0195, 0x0d950180, 0x0e56016e, 0x0f0d015e, 0x0fbc0150, 0x10630143,
+    0x11070264, 0x1238023e, 0x1357021d, 0x14660201, 0x156601e9, 0x165a01d3, 0x174401c0,
+    0x182401af, 0x18fe0331, 0x1a9602fe, 0x1c1502d2, 0x1d7e02ad, 0x1ed4028d, 0x201a0270,
+    0x21520256, 0x227d0240, 0x239f0443, 0x25c003fe, 0x27bf03c4, 0x29a10392, 0x2b6a0367,
+    0x2d1d0341, 0x2ebe031f, 0x304d0300, 0x31d105b0, 0x34a80555, 0x37520507, 0x39d504c5,
+    0x3c37048b, 0x3e7c0458, 0x40a8042a, 0x42bd0401, 0x44c20798, 0x488e071e, 0x4c1c06b6,
+    0x4f76065d, 0x52a50610, 0x55ac05cc, 0x5892058f, 0x5b590559, 0x5e0c0a23, 0x631c0980,
+    0x67db08f6, 0x6c55087f, 0x70940818, 0x74a007bd, 0x787d076c, 0x7c330723,
+};
+
+uint32_t SrgbByte(float v) {
+    // Written so NaN maps to the minimum, like the max/min pair in the vector kernels.
+    if (!(v > kSrgbMin)) {
+        v = kSrgbMin;
+    }
+    if (v > kSrgbAlmostOne) {
+        v = kSrgbAlmostOne;
+    }
+    uint32_t bits = 0;
+    std::memcpy(&bits, &v, sizeof(bits));
+    const uint32_t entry = kSrgbTable[(bits - kSrgbMinBits) >> 20];
+    const uint32_t bias = (entry >> 16) << 9;
+    const uint32_t scale = entry & 0xFFFFu;
+    const uint32_t t = (bits >> 12) & 0xFFu;
+    return (bias + scale * t) >> 16;
+}
+
+void ConvertLinearScalar(const Color4f* src, Color32* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = Color32::FromColor4f(src[i]);
+    }
+}
+
+void ConvertSrgbScalar(const Color4f* src, Color32* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t alpha = Color32::FromColor4f(src[i]).rgba & 0xFF000000u;
+        dst[i] = Color32::FromPacked(SrgbByte(src[i].r) | (SrgbByte(src[i].g) << 8) |
+                                     (SrgbByte(src[i].b) << 16) | alpha);
+    }
+}
+
+void FillScalar(Color32* dst, size_t count, Color32 color) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+
+// Image sampling. Every path computes coordinates as u + du * (first + i) and quantizes them the
+// same way, so the vector kernels, their scalar tails and differently split rows all agree.
+struct SampleSetup {
+    const Color32* texels;
+    const uint32_t* columns;
+    const uint32_t* rows;
+    float max_u;
+    float max_v;
+};
+
+SampleSetup MakeSampleSetup(const Image& image) {
+    return SampleSetup{image.Texels(), image.ColumnOffsets(), image.RowOffsets(),
+                       static_cast<float>(image.Width() - 1),
+                       static_cast<float>(image.Height() - 1)};
+}
+
+// Written so NaN clamps to 0, like the max/min pair in the vector kernels.
+float ClampCoord(float value, float max_value) {
+    return value > 0.0f ? (value < max_value ? value : max_value) : 0.0f;
+}
+
+void SampleNearestScalar(const SampleSetup& setup, float u, float v, float du, float dv,
+                         size_t first, Color32* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const float step = static_cast<float>(first + i);
+        const int x = static_cast<int>(ClampCoord(u + du * step, setup.max_u));
+        const int y = static_cast<int>(ClampCoord(v + dv * step, setup.max_v));
+        dst[i] = setup.texels[setup.columns[x] + setup.rows[y]];
+    }
+}
+
+// Weights are 8.8 fixed point. A row lerp stays below 255 * 256 + 128, so the 16-bit lanes of
+// the vector kernels hold it without overflow.
+uint32_t LerpChannels(uint32_t a, uint32_t b, uint32_t t) {
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const uint32_t ca = (a >> shift) & 0xFFu;
+        const uint32_t cb = (b >> shift) & 0xFFu;
+        out |= ((ca * (256u - t) + cb * t + 128u) >> 8) << shift;
+    }
+    return out;
+}
+
+void SampleBilinearScalar(const SampleSetup& setup, float u, float v, float du, float dv,
+                          size_t first, Color32* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const float step = static_cast<float>(first + i);
+        const int fu = static_cast<int>(ClampCoord(u + du * step - 0.5f, setup.max_u) * 256.0f);
+        const int fv = static_cast<int>(ClampCoord(v + dv * step - 0.5f, setup.max_v) * 256.0f);
+        const uint32_t c0 = setup.columns[fu >> 8];
+        const uint32_t c1 = setup.columns[(fu >> 8) + 1];
+        const uint32_t* row0 = &setup.texels[setup.rows[fv >> 8]].rgba;
+        const uint32_t* row1 = &setup.texels[setup.rows[(fv >> 8) + 1]].rgba;
+        const uint32_t tx = static_cast<uint32_t>(fu & 0xFF);
+        const uint32_t ty = static_cast<uint32_t>(fv & 0xFF);
+        dst[i] = Color32::FromPacked(LerpChannels(LerpChannels(row0[c0], row0[c1], tx),
+                                                  LerpChannels(row1[c0], row1[c1], tx), ty));
+    }
+}
+
+void ResolveBoxScalar(const Color32* src, size_t src_pitch, int factor, Color32* dst,
+                      size_t count) {
+    const uint32_t samples = static_cast<uint32_t>(factor * factor);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t sums[4] = {};
+        const Color32* block = src + i * static_cast<size_t>(factor);
+        for (int y = 0; y < factor; ++y) {
+            for (int x = 0; x < factor; ++x) {
+                const uint32_t pixel = block[static_cast<size_t>(y) * src_pitch + x].rgba;
+                for (int c = 0; c < 4; ++c) {
+                    sums[c] += (pixel >> (8 * c)) & 0xFFu;
+                }
+            }
+        }
+        uint32_t out = 0;
+        for (int c = 0; c < 4; ++c) {
+            out |= ((sums[c] + samples / 2) / samples) << (8 * c);
+        }
+        dst[i] = Color32::FromPacked(out);
+    }
+}
+
+#if !defined(SANDBOX_KERNELS_X86)
+void BlendFillScalar(Color32* dst, size_t count, Color32 color, BlendMode mode) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = BlendPixel(dst[i], color, mode);
+    }
+}
+
+void BlendSpanScalar(Color32* dst, const Color32* src, size_t count, BlendMode mode) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = BlendPixel(dst[i], src[i], mode);
+    }
+}
+#endif
+
+#if defined(SANDBOX_KERNELS_X86)
+bool HasAvx2() {
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // The CPU bit alone is not enough: the OS also has to save the YMM registers, which
+    // OSXSAVE plus the XMM and YMM state bits of XCR0 confirm.
+    __cpuid(info, 1);
+    const int osxsave_avx = (1 << 27) | (1 << 28);
+    if ((info[2] & osxsave_avx) != osxsave_avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// Scalar head until dst reaches the given alignment; returns the number of pixels written.
+size_t FillHead(Color32* dst, size_t count, Color32 color, uintptr_t alignment) {
+    size_t head = 0;
+    while (head < count && (reinterpret_cast<uintptr_t>(dst + head) & (alignment - 1)) != 0) {
+        dst[head++] = color;
+    }
+    return head;
+}
+
+template <bool kStream> void FillSse2(Color32* dst, size_t count, Color32 color) {
+    size_t i = FillHead(dst, count, color, 16);
+    const __m128i v = _mm_set1_epi32(static_cast<int>(color.rgba));
+    for (; i + 16 <= count; i += 16) {
+        __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+        if (kStream) {
+            _mm_stream_si128(p + 0, v);
+            _mm_stream_si128(p + 1, v);
+            _mm_stream_si128(p + 2, v);
+            _mm_stream_si128(p + 3, v);
+        } else {
+            _mm_store_si128(p + 0, v);
+            _mm_store_si128(p + 1, v);
+            _mm_store_si128(p + 2, v);
+            _mm_store_si128(p + 3, v);
+        }
+    }
+    for (; i + 4 <= count; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+        if (kStream) {
+            _mm_stream_si128(p, v);
+        } else {
+            _mm_store_si128(p, v);
+        }
+    }
+    FillScalar(dst + i, count - i, color);
+}
+
+template <bool kStream>
+SANDBOX_TARGET_AVX2 void FillAvx2(Color32* dst, size_t count, Color32 color) {
+    size_t i = FillHead(dst, count, color, 32);
+    const __m256i v = _mm256_set1_epi32(static_cast<int>(color.rgba));
+    for (; i + 32 <= count; i += 32) {
+        __m256i* p = reinterpret_cast<__m256i*>(dst + i);
+        if (kStream) {
+            _mm256_stream_si256(p + 0, v);
+            _mm256_stream_si256(p + 1, v);
+            _mm256_stream_si256(p + 2, v);
+            _mm256_stream_si256(p + 3, v);
+        } else {
+            _mm256_store_si256(p + 0, v);
+            _mm256_store_si256(p + 1, v);
+            _mm256_store_si256(p + 2, v);
+            _mm256_store_si256(p + 3, v);
+        }
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(dst + i);
+        if (kStream) {
+            _mm256_stream_si256(p, v);
+        } else {
+            _mm256_store_si256(p, v);
+        }
+    }
+    FillScalar(dst + i, count - i, color);
+}
+
+// Blend kernels work on 16-bit lanes: each 8-bit channel is widened, combined and narrowed
+// again with a saturating pack.
+__m128i Div255Epu16(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Blends two widened pixels. s is the source with its alpha lane forced to 255, a holds the
+// source alpha in every lane.
+__m128i BlendWide(__m128i d, __m128i s, __m128i a, BlendMode mode) {
+    const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    switch (mode) {
+    case BlendMode::Additive:
+        return _mm_add_epi16(d, Div255Epu16(_mm_mullo_epi16(s, a)));
+    case BlendMode::Multiply: {
+        const __m128i m = Div255Epu16(_mm_mullo_epi16(d, s));
+        return Div255Epu16(_mm_add_epi16(_mm_mullo_epi16(m, a), _mm_mullo_epi16(d, inv)));
+    }
+    default:
+        return Div255Epu16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, inv)));
+    }
+}
+
+__m128i BlendQuad(__m128i dst, __m128i src, BlendMode mode) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_lane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i s_lo = _mm_unpacklo_epi8(src, zero);
+    const __m128i s_hi = _mm_unpackhi_epi8(src, zero);
+    const __m128i a_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_lo, 0xFF), 0xFF);
+    const __m128i a_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_hi, 0xFF), 0xFF);
+    const __m128i lo = BlendWide(_mm_unpacklo_epi8(dst, zero), _mm_or_si128(s_lo, alpha_lane),
+                                 a_lo, mode);
+    const __m128i hi = BlendWide(_mm_unpackhi_epi8(dst, zero), _mm_or_si128(s_hi, alpha_lane),
+                                 a_hi, mode);
+    return _mm_packus_epi16(lo, hi);
+}
+
+void BlendSpanSse2(Color32* dst, const Color32* src, size_t count, BlendMode mode) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i* s = reinterpret_cast<const __m128i*>(src + i);
+        const __m128i d0 = _mm_loadu_si128(d);
+        const __m128i d1 = _mm_loadu_si128(d + 1);
+        _mm_storeu_si128(d, BlendQuad(d0, _mm_loadu_si128(s), mode));
+        _mm_storeu_si128(d + 1, BlendQuad(d1, _mm_loadu_si128(s + 1), mode));
+    }
+    if (i < count) {
+        // Staging the tail costs two small copies, far less than the per-pixel scalar path.
+        Color32 d_tail[8];
+        Color32 s_tail[8];
+        const size_t bytes = (count - i) * sizeof(Color32);
+        std::memcpy(d_tail, dst + i, bytes);
+        std::memcpy(s_tail, src + i, bytes);
+        BlendSpanSse2(d_tail, s_tail, 8, mode);
+        std::memcpy(dst + i, d_tail, bytes);
+    }
+}
+
+void BlendFillSse2(Color32* dst, size_t count, Color32 color, BlendMode mode) {
+    const __m128i src = _mm_set1_epi32(static_cast<int>(color.rgba));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i d0 = _mm_loadu_si128(d);
+        const __m128i d1 = _mm_loadu_si128(d + 1);
+        _mm_storeu_si128(d, BlendQuad(d0, src, mode));
+        _mm_storeu_si128(d + 1, BlendQuad(d1, src, mode));
+    }
+    if (i < count) {
+        Color32 tail[8];
+        const size_t bytes = (count - i) * sizeof(Color32);
+        std::memcpy(tail, dst + i, bytes);
+        BlendFillSse2(tail, 8, color, mode);
+        std::memcpy(dst + i, tail, bytes);
+    }
+}
+
+SANDBOX_TARGET_AVX2 __m256i Div255Epu16Avx2(__m256i x) {
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+SANDBOX_TARGET_AVX2 __m256i BlendWideAvx2(__m256i d, __m256i s, __m256i a, BlendMode mode) {
+    const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    switch (mode) {
+    case BlendMode::Additive:
+        return _mm256_add_epi16(d, Div255Epu16Avx2(_mm256_mullo_epi16(s, a)));
+    case BlendMode::Multiply: {
+        const __m256i m = Div255Epu16Avx2(_mm256_mullo_epi16(d, s));
+        return Div255Epu16Avx2(
+            _mm256_add_epi16(_mm256_mullo_epi16(m, a), _mm256_mullo_epi16(d, inv)));
+    }
+    default:
+        return Div255Epu16Avx2(
+            _mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, inv)));
+    }
+}
+
+// Eight pixels per call. Unpack and pack both work per 128-bit lane, so pixel order survives
+// the round trip.
+SANDBOX_TARGET_AVX2 __m256i BlendOctet(__m256i dst, __m256i src, BlendMode mode) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha_lane =
+        _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    const __m256i s_lo = _mm256_unpacklo_epi8(src, zero);
+    const __m256i s_hi = _mm256_unpackhi_epi8(src, zero);
+    const __m256i a_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_lo, 0xFF), 0xFF);
+    const __m256i a_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_hi, 0xFF), 0xFF);
+    const __m256i lo = BlendWideAvx2(_mm256_unpacklo_epi8(dst, zero),
+                                     _mm256_or_si256(s_lo, alpha_lane), a_lo, mode);
+    const __m256i hi = BlendWideAvx2(_mm256_unpackhi_epi8(dst, zero),
+                                     _mm256_or_si256(s_hi, alpha_lane), a_hi, mode);
+    return _mm256_packus_epi16(lo, hi);
+}
+
+SANDBOX_TARGET_AVX2 void BlendSpanAvx2(Color32* dst, const Color32* src, size_t count,
+                                       BlendMode mode) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+        const __m256i* s = reinterpret_cast<const __m256i*>(src + i);
+        const __m256i d0 = _mm256_loadu_si256(d);
+        const __m256i d1 = _mm256_loadu_si256(d + 1);
+        _mm256_storeu_si256(d, BlendOctet(d0, _mm256_loadu_si256(s), mode));
+        _mm256_storeu_si256(d + 1, BlendOctet(d1, _mm256_loadu_si256(s + 1), mode));
+    }
+    // The tail runs legacy-SSE code; without this the dirty upper halves cost a state
+    // transition on every instruction there.
+    _mm256_zeroupper();
+    BlendSpanSse2(dst + i, src + i, count - i, mode);
+}
+
+SANDBOX_TARGET_AVX2 void BlendFillAvx2(Color32* dst, size_t count, Color32 color,
+                                       BlendMode mode) {
+    const __m256i src = _mm256_set1_epi32(static_cast<int>(color.rgba));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+        const __m256i d0 = _mm256_loadu_si256(d);
+        const __m256i d1 = _mm256_loadu_si256(d + 1);
+        _mm256_storeu_si256(d, BlendOctet(d0, src, mode));
+        _mm256_storeu_si256(d + 1, BlendOctet(d1, src, mode));
+    }
+    _mm256_zeroupper();
+    BlendFillSse2(dst + i, count - i, color, mode);
+}
+
+// Color conversion works on one pixel per 128-bit register: each Color4f is already an RGBA
+// float quad, so a load, a clamp, a scale and a truncating convert give four channel bytes in
+// 32-bit lanes, and two saturating packs narrow four pixels into one register.
+__m128i LinearBytes(__m128 v) {
+    // max returns its second operand for NaN, so NaN clamps to zero.
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+// SSE2 has no gather, so the four table entries are fetched with scalar loads; the clamp and
+// the interpolation stay in vector registers.
+__m128i SrgbBytes(__m128 v) {
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(kSrgbMin)), _mm_set1_ps(kSrgbAlmostOne));
+    const __m128i bits = _mm_castps_si128(v);
+    const __m128i min_bits = _mm_set1_epi32(static_cast<int>(kSrgbMinBits));
+    alignas(16) uint32_t index[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(index),
+                    _mm_srli_epi32(_mm_sub_epi32(bits, min_bits), 20));
+    const __m128i entry = _mm_set_epi32(
+        static_cast<int>(kSrgbTable[index[3]]), static_cast<int>(kSrgbTable[index[2]]),
+        static_cast<int>(kSrgbTable[index[1]]), static_cast<int>(kSrgbTable[index[0]]));
+    const __m128i bias = _mm_slli_epi32(_mm_srli_epi32(entry, 16), 9);
+    const __m128i scale = _mm_and_si128(entry, _mm_set1_epi32(0xFFFF));
+    const __m128i t = _mm_and_si128(_mm_srli_epi32(bits, 12), _mm_set1_epi32(0xFF));
+    // Both factors fit in the low 16 bits of each lane, so madd is a 32-bit multiply here.
+    return _mm_srli_epi32(_mm_add_epi32(bias, _mm_madd_epi16(scale, t)), 16);
+}
+
+template <TransferFunction kTransfer> __m128i ConvertPixelSse2(const Color4f* src) {
+    const __m128 v = _mm_loadu_ps(&src->r);
+    if (kTransfer == TransferFunction::Linear) {
+        return LinearBytes(v);
+    }
+    const __m128i alpha = _mm_set_epi32(-1, 0, 0, 0);
+    return _mm_or_si128(_mm_and_si128(alpha, LinearBytes(v)),
+                        _mm_andnot_si128(alpha, SrgbBytes(v)));
+}
+
+template <TransferFunction kTransfer>
+void ConvertSse2(const Color4f* src, Color32* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i p01 = _mm_packs_epi32(ConvertPixelSse2<kTransfer>(src + i),
+                                            ConvertPixelSse2<kTransfer>(src + i + 1));
+        const __m128i p23 = _mm_packs_epi32(ConvertPixelSse2<kTransfer>(src + i + 2),
+                                            ConvertPixelSse2<kTransfer>(src + i + 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(p01, p23));
+    }
+    if (kTransfer == TransferFunction::Linear) {
+        ConvertLinearScalar(src + i, dst + i, count - i);
+    } else {
+        ConvertSrgbScalar(src + i, dst + i, count - i);
+    }
+}
+
+SANDBOX_TARGET_AVX2 __m256i LinearBytesAvx2(__m256 v) {
+    v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+    return _mm256_cvttps_epi32(
+        _mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+}
+
+SANDBOX_TARGET_AVX2 __m256i SrgbBytesAvx2(__m256 v) {
+    v = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(kSrgbMin)),
+                      _mm256_set1_ps(kSrgbAlmostOne));
+    const __m256i bits = _mm256_castps_si256(v);
+    const __m256i min_bits = _mm256_set1_epi32(static_cast<int>(kSrgbMinBits));
+    const __m256i index = _mm256_srli_epi32(_mm256_sub_epi32(bits, min_bits), 20);
+    const __m256i entry =
+        _mm256_i32gather_epi32(reinterpret_cast<const int*>(kSrgbTable), index, 4);
+    const __m256i bias = _mm256_slli_epi32(_mm256_srli_epi32(entry, 16), 9);
+    const __m256i scale = _mm256_and_si256(entry, _mm256_set1_epi32(0xFFFF));
+    const __m256i t = _mm256_and_si256(_mm256_srli_epi32(bits, 12), _mm256_set1_epi32(0xFF));
+    return _mm256_srli_epi32(_mm256_add_epi32(bias, _mm256_mullo_epi32(scale, t)), 16);
+}
+
+// Two pixels per register.
+template <TransferFunction kTransfer>
+SANDBOX_TARGET_AVX2 __m256i ConvertPairAvx2(const Color4f* src) {
+    const __m256 v = _mm256_loadu_ps(&src->r);
+    if (kTransfer == TransferFunction::Linear) {
+        return LinearBytesAvx2(v);
+    }
+    const __m256i alpha = _mm256_set_epi32(-1, 0, 0, 0, -1, 0, 0, 0);
+    return _mm256_blendv_epi8(SrgbBytesAvx2(v), LinearBytesAvx2(v), alpha);
+}
+
+// Eight pixels per iteration. The packs work per 128-bit lane, which leaves even pixels in the
+// low lane and odd ones in the high lane; a cross-lane permute restores the order.
+template <TransferFunction kTransfer>
+SANDBOX_TARGET_AVX2 void ConvertAvx2(const Color4f* src, Color32* dst, size_t count) {
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i p0 = _mm256_packs_epi32(ConvertPairAvx2<kTransfer>(src + i),
+                                              ConvertPairAvx2<kTransfer>(src + i + 2));
+        const __m256i p1 = _mm256_packs_epi32(ConvertPairAvx2<kTransfer>(src + i + 4),
+                                              ConvertPairAvx2<kTransfer>(src + i + 6));
+        const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(p0, p1), order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    _mm256_zeroupper();
+    ConvertSse2<kTransfer>(src + i, dst + i, count - i);
+}
+
+// Bilinear filtering of four pixels whose corner texels are already loaded. Each half widens two
+// pixels to 16-bit channels; the weights are spread to match, four lanes per pixel.
+__m128i LerpWide(__m128i a, __m128i b, __m128i t) {
+    const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(256), t);
+    const __m128i sum = _mm_add_epi16(_mm_mullo_epi16(a, inv), _mm_mullo_epi16(b, t));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+}
+
+__m128i BilinearQuad(__m128i tl, __m128i tr, __m128i bl, __m128i br, __m128i tx, __m128i ty) {
+    const __m128i zero = _mm_setzero_si128();
+    // tx and ty hold one weight per 32-bit lane; copy it into both 16-bit halves first.
+    tx = _mm_or_si128(tx, _mm_slli_epi32(tx, 16));
+    ty = _mm_or_si128(ty, _mm_slli_epi32(ty, 16));
+    const __m128i tx_lo = _mm_unpacklo_epi32(tx, tx);
+    const __m128i tx_hi = _mm_unpackhi_epi32(tx, tx);
+    const __m128i ty_lo = _mm_unpacklo_epi32(ty, ty);
+    const __m128i ty_hi = _mm_unpackhi_epi32(ty, ty);
+    const __m128i lo = LerpWide(
+        LerpWide(_mm_unpacklo_epi8(tl, zero), _mm_unpacklo_epi8(tr, zero), tx_lo),
+        LerpWide(_mm_unpacklo_epi8(bl, zero), _mm_unpacklo_epi8(br, zero), tx_lo), ty_lo);
+    const __m128i hi = LerpWide(
+        LerpWide(_mm_unpackhi_epi8(tl, zero), _mm_unpackhi_epi8(tr, zero), tx_hi),
+        LerpWide(_mm_unpackhi_epi8(bl, zero), _mm_unpackhi_epi8(br, zero), tx_hi), ty_hi);
+    return _mm_packus_epi16(lo, hi);
+}
+
+// SSE2 has no gather, so the texel fetches are scalar; the coordinate math and the filter run
+// four pixels at a time.
+void SampleBilinearSse2(const SampleSetup& setup, float u, float v, float du, float dv,
+                        size_t first, Color32* dst, size_t count) {
+    const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 scale = _mm_set1_ps(256.0f);
+    const __m128 max_u = _mm_set1_ps(setup.max_u);
+    const __m128 max_v = _mm_set1_ps(setup.max_v);
+    const __m128i fraction = _mm_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 step = _mm_add_ps(_mm_set1_ps(static_cast<float>(first + i)), lane);
+        __m128 su = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(u), _mm_mul_ps(_mm_set1_ps(du), step)), half);
+        __m128 sv = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(v), _mm_mul_ps(_mm_set1_ps(dv), step)), half);
+        su = _mm_min_ps(_mm_max_ps(su, _mm_setzero_ps()), max_u);
+        sv = _mm_min_ps(_mm_max_ps(sv, _mm_setzero_ps()), max_v);
+        const __m128i fu = _mm_cvttps_epi32(_mm_mul_ps(su, scale));
+        const __m128i fv = _mm_cvttps_epi32(_mm_mul_ps(sv, scale));
+        alignas(16) int32_t x[4];
+        alignas(16) int32_t y[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(x), _mm_srai_epi32(fu, 8));
+        _mm_store_si128(reinterpret_cast<__m128i*>(y), _mm_srai_epi32(fv, 8));
+        alignas(16) uint32_t corners[4][4];
+        for (int k = 0; k < 4; ++k) {
+            const uint32_t c0 = setup.columns[x[k]];
+            const uint32_t c1 = setup.columns[x[k] + 1];
+            const uint32_t r0 = setup.rows[y[k]];
+            const uint32_t r1 = setup.rows[y[k] + 1];
+            corners[0][k] = setup.texels[c0 + r0].rgba;
+            corners[1][k] = setup.texels[c1 + r0].rgba;
+            corners[2][k] = setup.texels[c0 + r1].rgba;
+            corners[3][k] = setup.texels[c1 + r1].rgba;
+        }
+        const __m128i* c = reinterpret_cast<const __m128i*>(corners);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         BilinearQuad(_mm_load_si128(c), _mm_load_si128(c + 1),
+                                      _mm_load_si128(c + 2), _mm_load_si128(c + 3),
+                                      _mm_and_si128(fu, fraction), _mm_and_si128(fv, fraction)));
+    }
+    SampleBilinearScalar(setup, u, v, du, dv, first + i, dst + i, count - i);
+}
+
+// 2x2 resolve, four output pixels per iteration. A float shuffle splits each run of eight
+// samples into even and odd columns, so adding the two (and the second row) sums every block
+// in 16-bit lanes; the largest sum, 4 * 255, leaves plenty of headroom.
+void ResolveBox2Sse2(const Color32* src, size_t src_pitch, Color32* dst, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i lo = zero;
+        __m128i hi = zero;
+        for (size_t row = 0; row < 2; ++row) {
+            const float* p = reinterpret_cast<const float*>(src + row * src_pitch + i * 2);
+            const __m128 a = _mm_loadu_ps(p);
+            const __m128 b = _mm_loadu_ps(p + 4);
+            const __m128i even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            lo = _mm_add_epi16(lo, _mm_add_epi16(_mm_unpacklo_epi8(even, zero),
+                                                 _mm_unpacklo_epi8(odd, zero)));
+            hi = _mm_add_epi16(hi, _mm_add_epi16(_mm_unpackhi_epi8(even, zero),
+                                                 _mm_unpackhi_epi8(odd, zero)));
+        }
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 2);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    ResolveBoxScalar(src + i * 2, src_pitch, 2, dst + i, count - i);
+}
+
+// Sum of one output pixel's 4x4 block in the low four 16-bit lanes (at most 16 * 255).
+__m128i SumBlock4(const Color32* src, size_t src_pitch) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = zero;
+    for (size_t row = 0; row < 4; ++row) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + row * src_pitch));
+        sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_unpacklo_epi8(v, zero),
+                                               _mm_unpackhi_epi8(v, zero)));
+    }
+    return _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+}
+
+void ResolveBox4Sse2(const Color32* src, size_t src_pitch, Color32* dst, size_t count) {
+    const __m128i round = _mm_set1_epi16(8);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const Color32* block = src + i * 4;
+        __m128i lo = _mm_unpacklo_epi64(SumBlock4(block, src_pitch),
+                                        SumBlock4(block + 4, src_pitch));
+        __m128i hi = _mm_unpacklo_epi64(SumBlock4(block + 8, src_pitch),
+                                        SumBlock4(block + 12, src_pitch));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 4);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 4);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    ResolveBoxScalar(src + i * 4, src_pitch, 4, dst + i, count - i);
+}
+
+SANDBOX_TARGET_AVX2 __m256i LerpWideAvx2(__m256i a, __m256i b, __m256i t) {
+    const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(256), t);
+    const __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(a, inv), _mm256_mullo_epi16(b, t));
+    return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(128)), 8);
+}
+
+// Eight pixels. Unpack works per 128-bit lane, so the low halves hold pixels 0, 1, 4, 5 and the
+// high halves 2, 3, 6, 7; the weights are spread the same way and the pack restores the order.
+SANDBOX_TARGET_AVX2 __m256i BilinearOctet(__m256i tl, __m256i tr, __m256i bl, __m256i br,
+                                          __m256i tx, __m256i ty) {
+    const __m256i zero = _mm256_setzero_si256();
+    tx = _mm256_or_si256(tx, _mm256_slli_epi32(tx, 16));
+    ty = _mm256_or_si256(ty, _mm256_slli_epi32(ty, 16));
+    const __m256i tx_lo = _mm256_unpacklo_epi32(tx, tx);
+    const __m256i tx_hi = _mm256_unpackhi_epi32(tx, tx);
+    const __m256i ty_lo = _mm256_unpacklo_epi32(ty, ty);
+    const __m256i ty_hi = _mm256_unpackhi_epi32(ty, ty);
+    const __m256i lo = LerpWideAvx2(
+        LerpWideAvx2(_mm256_unpacklo_epi8(tl, zero), _mm256_unpacklo_epi8(tr, zero), tx_lo),
+        LerpWideAvx2(_mm256_unpacklo_epi8(bl, zero), _mm256_unpacklo_epi8(br, zero), tx_lo),
+        ty_lo);
+    const __m256i hi = LerpWideAvx2(
+        LerpWideAvx2(_mm256_unpackhi_epi8(tl, zero), _mm256_unpackhi_epi8(tr, zero), tx_hi),
+        LerpWideAvx2(_mm256_unpackhi_epi8(bl, zero), _mm256_unpackhi_epi8(br, zero), tx_hi),
+        ty_hi);
+    return _mm256_packus_epi16(lo, hi);
+}
+
+// Sample coordinates of pixels [first, first + 8) as 24.8 fixed point, clamped to the image.
+SANDBOX_TARGET_AVX2 __m256i FixedCoordAvx2(float origin, float delta, float bias, float max_value,
+                                           size_t first) {
+    const __m256 step =
+        _mm256_add_ps(_mm256_set1_ps(static_cast<float>(first)),
+                      _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+    __m256 s = _mm256_add_ps(_mm256_set1_ps(origin),
+                             _mm256_mul_ps(_mm256_set1_ps(delta), step));
+    s = _mm256_sub_ps(s, _mm256_set1_ps(bias));
+    s = _mm256_min_ps(_mm256_max_ps(s, _mm256_setzero_ps()), _mm256_set1_ps(max_value));
+    return _mm256_cvttps_epi32(_mm256_mul_ps(s, _mm256_set1_ps(256.0f)));
+}
+
+SANDBOX_TARGET_AVX2 __m256i GatherOffsets(const uint32_t* table, __m256i index) {
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 4);
+}
+
+SANDBOX_TARGET_AVX2 __m256i GatherTexels(const Color32* texels, __m256i column, __m256i row) {
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(texels),
+                                  _mm256_add_epi32(column, row), 4);
+}
+
+SANDBOX_TARGET_AVX2 void SampleBilinearAvx2(const SampleSetup& setup, float u, float v, float du,
+                                            float dv, size_t first, Color32* dst, size_t count) {
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i fraction = _mm256_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i fu = FixedCoordAvx2(u, du, 0.5f, setup.max_u, first + i);
+        const __m256i fv = FixedCoordAvx2(v, dv, 0.5f, setup.max_v, first + i);
+        const __m256i x = _mm256_srai_epi32(fu, 8);
+        const __m256i y = _mm256_srai_epi32(fv, 8);
+        const __m256i c0 = GatherOffsets(setup.columns, x);
+        const __m256i c1 = GatherOffsets(setup.columns, _mm256_add_epi32(x, one));
+        const __m256i r0 = GatherOffsets(setup.rows, y);
+        const __m256i r1 = GatherOffsets(setup.rows, _mm256_add_epi32(y, one));
+        const __m256i out = BilinearOctet(
+            GatherTexels(setup.texels, c0, r0), GatherTexels(setup.texels, c1, r0),
+            GatherTexels(setup.texels, c0, r1), GatherTexels(setup.texels, c1, r1),
+            _mm256_and_si256(fu, fraction), _mm256_and_si256(fv, fraction));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    }
+    _mm256_zeroupper();
+    SampleBilinearScalar(setup, u, v, du, dv, first + i, dst + i, count - i);
+}
+
+// Truncating the 24.8 coordinate to whole texels gives the same texel as truncating the float,
+// which is what the scalar tail does.
+SANDBOX_TARGET_AVX2 void SampleNearestAvx2(const SampleSetup& setup, float u, float v, float du,
+                                           float dv, size_t first, Color32* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i fu = FixedCoordAvx2(u, du, 0.0f, setup.max_u, first + i);
+        const __m256i fv = FixedCoordAvx2(v, dv, 0.0f, setup.max_v, first + i);
+        const __m256i x = _mm256_srai_epi32(fu, 8);
+        const __m256i y = _mm256_srai_epi32(fv, 8);
+        const __m256i out = GatherTexels(setup.texels, GatherOffsets(setup.columns, x),
+                                         GatherOffsets(setup.rows, y));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    }
+    _mm256_zeroupper();
+    SampleNearestScalar(setup, u, v, du, dv, first + i, dst + i, count - i);
+}
+#endif
+
+FillFn SelectFill(bool stream) {
+#if defined(SANDBOX_KERNELS_X86)
+    if (HasAvx2()) {
+        return stream ? FillAvx2<true> : FillAvx2<false>;
+    }
+    return stream ? FillSse2<true> : FillSse2<false>;
+#else
+    (void)stream;
+    return FillScalar;
+#endif
+}
+
+BlendFillFn SelectBlendFill() {
+#if defined(SANDBOX_KERNELS_X86)
+    return HasAvx2() ? BlendFillAvx2 : BlendFillSse2;
+#else
+    return BlendFillScalar;
+#endif
+}
+
+ConvertFn SelectConvert(TransferFunction transfer) {
+    const bool srgb = transfer == TransferFunction::Srgb;
+#if defined(SANDBOX_KERNELS_X86)
+    if (HasAvx2()) {
+        return srgb ? ConvertAvx2<TransferFunction::Srgb> : ConvertAvx2<TransferFunction::Linear>;
+    }
+    return srgb ? ConvertSse2<TransferFunction::Srgb> : ConvertSse2<TransferFunction::Linear>;
+#else
+    return srgb ? ConvertSrgbScalar : ConvertLinearScalar;
+#endif
+}
+
+SampleFn SelectSample(ImageFilter filter) {
+    const bool bilinear = filter == ImageFilter::Bilinear;
+#if defined(SANDBOX_KERNELS_X86)
+    if (HasAvx2()) {
+        return bilinear ? SampleBilinearAvx2 : SampleNearestAvx2;
+    }
+    if (bilinear) {
+        return SampleBilinearSse2;
+    }
+#endif
+    if (bilinear) {
+        return SampleBilinearScalar;
+    }
+    return SampleNearestScalar;
+}
+
+BlendSpanFn SelectBlendSpan() {
+#if defined(SANDBOX_KERNELS_X86)
+    return HasAvx2() ? BlendSpanAvx2 : BlendSpanSse2;
+#else
+    return BlendSpanScalar;
+#endif
+}
+} // namespace
+
+void FillPixels(Color32* dst, size_t count, Color32 color) {
+    static const FillFn fill = SelectFill(false);
+    // Short spans (lines, small shapes) are dominated by call and alignment overhead.
+    if (count < 16) {
+        FillScalar(dst, count, color);
+        return;
+    }
+    fill(dst, count, color);
+}
+
+void FillPixelsStreaming(Color32* dst, size_t count, Color32 color) {
+    static const FillFn fill = SelectFill(true);
+    fill(dst, count, color);
+}
+
+void StreamFence() {
+#if defined(SANDBOX_KERNELS_X86)
+    _mm_sfence();
+#endif
+}
+
+void BlendFill(Color32* dst, size_t count, Color32 color, BlendMode mode) {
+    static const BlendFillFn blend = SelectBlendFill();
+    const uint8_t alpha = color.A();
+    if (mode == BlendMode::Replace || (mode == BlendMode::SourceOver && alpha == 255)) {
+        FillPixels(dst, count, color);
+        return;
+    }
+    if (alpha == 0) {
+        return;
+    }
+    blend(dst, count, color, mode);
+}
+
+void BlendSpan(Color32* dst, const Color32* src, size_t count, BlendMode mode) {
+    static const BlendSpanFn blend = SelectBlendSpan();
+    if (mode == BlendMode::Replace) {
+        std::memcpy(dst, src, count * sizeof(Color32));
+        return;
+    }
+    blend(dst, src, count, mode);
+}
+
+void ConvertColors(const Color4f* src, Color32* dst, size_t count, TransferFunction transfer) {
+    static const ConvertFn linear = SelectConvert(TransferFunction::Linear);
+    static const ConvertFn srgb = SelectConvert(TransferFunction::Srgb);
+    (transfer == TransferFunction::Srgb ? srgb : linear)(src, dst, count);
+}
+
+void SampleImage(const Image& image, ImageFilter filter, float u, float v, float du, float dv,
+                 size_t first, Color32* dst, size_t count) {
+    static const SampleFn nearest = SelectSample(ImageFilter::Nearest);
+    static const SampleFn bilinear = SelectSample(ImageFilter::Bilinear);
+    if (image.Empty() || count == 0) {
+        return;
+    }
+    (filter == ImageFilter::Bilinear ? bilinear : nearest)(MakeSampleSetup(image), u, v, du, dv,
+                                                           first, dst, count);
+}
+
+void ResolveBox(const Color32* src, size_t src_pitch, int factor, Color32* dst, size_t count) {
+#if defined(SANDBOX_KERNELS_X86)
+    // The resolve streams through memory once, so SSE2 already keeps up with the loads.
+    if (factor == 2) {
+        ResolveBox2Sse2(src, src_pitch, dst, count);
+        return;
+    }
+    if (factor == 4) {
+        ResolveBox4Sse2(src, src_pitch, dst, count);
+        return;
+    }
+#endif
+    ResolveBoxScalar(src, src_pitch, factor, dst, count);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "engine/core/BlendMode.h"
+#include "engine/core/Color32.h"
+#include "engine/core/Color4f.h"
+#include "engine/core/Image.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Span kernels shared by the CPU renderers. Each entry point picks the widest instruction set
+// the host supports (AVX2, SSE2, then scalar) the first time it is called.
+
+// Fills above this size bypass the cache with non-temporal stores. Below it the target usually
+// still fits in the last-level cache and regular stores are as fast and keep it warm for the
+// draws and the upload that follow.
+constexpr size_t kStreamingFillBytes = size_t{8} << 20;
+
+void FillPixels(Color32* dst, size_t count, Color32 color);
+// Non-temporal variant for large fills. Call StreamFence() once after the last streaming
+// store and before anything else reads the memory.
+void FillPixelsStreaming(Color32* dst, size_t count, Color32 color);
+void StreamFence();
+
+// Blends one source color into count destination pixels.
+void BlendFill(Color32* dst, size_t count, Color32 color, BlendMode mode);
+// Blends src[i] into dst[i]; each source pixel carries its own alpha.
+void BlendSpan(Color32* dst, const Color32* src, size_t count, BlendMode mode);
+
+// How ConvertColors encodes the color channels. Alpha is always stored linearly.
+enum class TransferFunction {
+    Linear,
+    // The sRGB curve through a 104-entry table; within 0.55 of the exact 8-bit value.
+    Srgb,
+};
+
+// Converts count float colors to packed pixels, clamping each channel to [0, 1] (NaN becomes 0).
+// Linear output matches Color32::FromColor4f byte for byte.
+void ConvertColors(const Color4f* src, Color32* dst, size_t count,
+                   TransferFunction transfer = TransferFunction::Linear);
+
+// Samples count pixels of a blit row: dst[i] reads the image at (u + n * du, v + n * dv) with
+// n = first + i, in texels whose centers lie at (x + 0.5, y + 0.5). Taking the row origin and an
+// index rather than a running coordinate keeps the result independent of how a row is split.
+// Coordinates clamp to the image and bilinear weights are quantized to 1/256.
+void SampleImage(const Image& image, ImageFilter filter, float u, float v, float du, float dv,
+                 size_t first, Color32* dst, size_t count);
+
+// Box-filters count factor x factor blocks of src, whose rows are src_pitch pixels apart, into
+// count pixels of dst: each channel is the rounded mean of its block. 2 and 4 are vectorized.
+void ResolveBox(const Color32* src, size_t src_pitch, int factor, Color32* dst, size_t count);
+
+// x / 255 rounded, exact for x in [0, 255 * 255].
+inline uint32_t Div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// Scalar reference for the vector kernels; also used for scattered points. Source alpha is
+// straight (not premultiplied). The destination alpha channel is treated as a color channel
+// whose source value is 255, so source-over produces the usual a + d * (1 - a) coverage.
+inline Color32 BlendPixel(Color32 dst, Color32 src, BlendMode mode) {
+    const uint32_t a = src.A();
+    if (mode == BlendMode::Replace) {
+        return src;
+    }
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const uint32_t d = (dst.rgba >> shift) & 0xFFu;
+        const uint32_t s = shift == 24 ? 255u : (src.rgba >> shift) & 0xFFu;
+        uint32_t c = d;
+        switch (mode) {
+        case BlendMode::SourceOver:
+            c = Div255(s * a + d * (255u - a));
+            break;
+        case BlendMode::Additive:
+            c = d + Div255(s * a);
+            c = c > 255u ? 255u : c;
+            break;
+        case BlendMode::Multiply:
+            c = Div255(Div255(d * s) * a + d * (255u - a));
+            break;
+        default:
+            break;
+        }
+        out |= c << shift;
+    }
+    return Color32::FromPacked(out);
+}
+
+// Blends color into dst with its alpha scaled by coverage (255 = fully covered). Replace is
+// treated as SourceOver at full opacity so partially covered pixels still blend.
+inline Color32 BlendCoverage(Color32 dst, Color32 color, uint8_t coverage, BlendMode mode) {
+    const uint32_t alpha = mode == BlendMode::Replace ? 255u : color.A();
+    const Color32 src =
+        Color32::FromPacked((color.rgba & 0x00FFFFFFu) | (Div255(alpha * coverage) << 24));
+    return BlendPixel(dst, src, mode == BlendMode::Replace ? BlendMode::SourceOver : mode);
+}
@@ -0,0 +1,59 @@
+#include "engine/render/PixelPacking.h"
+
+#include <cstring>
+
+namespace {
+// Plain loops over independent pixels; the compiler vectorizes them.
+void PackBgra8(const Color32* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t rgba = src[i].rgba;
+        const uint32_t bgra =
+            (rgba & 0xFF00FF00u) | ((rgba & 0xFFu) << 16) | ((rgba >> 16) & 0xFFu);
+        std::memcpy(dst + i * 4, &bgra, sizeof(bgra));
+    }
+}
+
+void PackRgb565(const Color32* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t rgba = src[i].rgba;
+        const uint32_t rgb =
+            ((rgba & 0xF8u) << 8) | ((rgba >> 5) & 0x07E0u) | ((rgba >> 19) & 0x1Fu);
+        const uint16_t packed = static_cast<uint16_t>(rgb);
+        std::memcpy(dst + i * 2, &packed, sizeof(packed));
+    }
+}
+
+void PackPalette8(const Color32* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t rgba = src[i].rgba;
+        dst[i] = static_cast<uint8_t>((rgba & 0xE0u) | ((rgba >> 11) & 0x1Cu) |
+                                      ((rgba >> 22) & 0x03u));
+    }
+}
+} // namespace
+
+void PackPixels(const Color32* src, uint8_t* dst, size_t count, PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        std::memcpy(dst, src, count * sizeof(Color32));
+        break;
+    case PixelFormat::BGRA8:
+        PackBgra8(src, dst, count);
+        break;
+    case PixelFormat::RGB565:
+        PackRgb565(src, dst, count);
+        break;
+    case PixelFormat::Palette8:
+        PackPalette8(src, dst, count);
+        break;
+    }
+}
+
+Color32 PalettePixel(uint8_t index) {
+    const uint32_t r = (index >> 5) & 7u;
+    const uint32_t g = (index >> 2) & 7u;
+    const uint32_t b = index & 3u;
+    return Color32::FromBytes(static_cast<uint8_t>(r * 255u / 7u),
+                              static_cast<uint8_t>(g * 255u / 7u),
+                              static_cast<uint8_t>(b * 255u / 3u));
+}
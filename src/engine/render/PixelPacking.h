@@ -0,0 +1,14 @@
+#pragma once
+
+#include "engine/core/Color32.h"
+#include "engine/core/PixelFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Converts count RGBA8 pixels to format, writing count * BytesPerPixel(format) bytes.
+void PackPixels(const Color32* src, uint8_t* dst, size_t count, PixelFormat format);
+
+// Entry index of the Palette8 palette: 3 bits of red, 3 of green and 2 of blue, so packing is a
+// few shifts and the palette is a fixed 256-entry ramp the presenters expand on the GPU.
+Color32 PalettePixel(uint8_t index);
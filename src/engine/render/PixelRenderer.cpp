@@ -1,71 +1,909 @@
 #include "engine/render/PixelRenderer.h"
 
+#include "engine/render/ImageBlit.h"
+#include "engine/render/PixelKernels.h"
+#include "engine/render/PixelPacking.h"
+
 #include <algorithm>
-#include <array>
-#include <cmath>
 #include <cstring>
 
 namespace {
-constexpr size_t kLutSize = 4096;
+constexpr int kTileShift = 3;
+constexpr int kTileMask = PixelRenderer::kTileSize - 1;
+constexpr size_t kTilePixels = static_cast<size_t>(PixelRenderer::kTileSize) *
+                               static_cast<size_t>(PixelRenderer::kTileSize);
+static_assert((1 << kTileShift) == PixelRenderer::kTileSize, "kTileShift must match kTileSize");
 
-const std::array<uint8_t, kLutSize>& GetColorLut() {
-    static const std::array<uint8_t, kLutSize> lut = [] {
-        std::array<uint8_t, kLutSize> table{};
-        for (size_t i = 0; i < kLutSize; ++i) {
-            float t = static_cast<float>(i) / static_cast<float>(kLutSize - 1);
-            table[i] = static_cast<uint8_t>(std::round(t * 255.0f));
-        }
-        return table;
-    }();
-    return lut;
+size_t TiledOffset(unsigned x, unsigned y, size_t tiles_x) {
+    const size_t tile = static_cast<size_t>(y >> kTileShift) * tiles_x + (x >> kTileShift);
+    return tile * kTilePixels + ((y & kTileMask) << kTileShift) + (x & kTileMask);
 }
 
-uint8_t ToByteLut(float v) {
-    float clamped = std::clamp(v, 0.0f, 1.0f);
-    float scaled = clamped * static_cast<float>(kLutSize - 1);
-    size_t idx = static_cast<size_t>(scaled + 0.5f);
-    return GetColorLut()[idx];
-}
+// Overdraw heatmap colors by write count; the last one covers every higher count.
+constexpr Color32 kHeatmap[] = {
+    Color32::FromBytes(0, 0, 0),       Color32::FromBytes(20, 40, 140),
+    Color32::FromBytes(0, 120, 200),   Color32::FromBytes(0, 180, 90),
+    Color32::FromBytes(170, 210, 0),   Color32::FromBytes(250, 200, 0),
+    Color32::FromBytes(250, 120, 0),   Color32::FromBytes(230, 30, 30),
+    Color32::FromBytes(255, 255, 255),
+};
+constexpr size_t kHeatmapLevels = sizeof(kHeatmap) / sizeof(kHeatmap[0]);
 } // namespace
 
 PixelRenderer::PixelRenderer(int width, int height) { Resize(width, height); }
 
-PixelRenderer::Pixel PixelRenderer::ColorToPixel(const Color4f& color) {
-    return Pixel{ToByteLut(color.r), ToByteLut(color.g), ToByteLut(color.b), ToByteLut(color.a)};
-}
-
 void PixelRenderer::Resize(int width, int height) {
     width_ = std::max(0, width);
     height_ = std::max(0, height);
-    pixels_.assign(static_cast<size_t>(width_ * height_), Pixel{});
-    clear_row_.clear();
-    clear_row_valid_ = false;
+    // An attached target stays attached: detaching here would allocate and fill owned storage
+    // only for the caller to attach a target of the new size and free it again.
+    capacity_width_ = std::max(capacity_width_, width_);
+    capacity_height_ = std::max(capacity_height_, height_);
+    Allocate();
+    depth_.Resize(width_, height_);
+    damage_.Resize(width_, height_);
+    detile_damage_.Resize(width_, height_);
+    pack_damage_.Resize(width_, height_);
+    if (overdraw_view_) {
+        ResetOverdraw();
+    }
+}
+
+void PixelRenderer::SetLayout(FramebufferLayout layout) {
+    if (layout == layout_) {
+        return;
+    }
+    layout_ = layout;
+    Allocate();
+    damage_.Resize(width_, height_);
+    detile_damage_.Resize(width_, height_);
+    pack_damage_.Resize(width_, height_);
+}
+
+void PixelRenderer::SetOutputFormat(PixelFormat format) {
+    if (format == format_) {
+        return;
+    }
+    format_ = format;
+    AllocatePacked();
+    // Every pixel changes representation, but the drawn regions the next clear has to revert
+    // are still the same, so damage_ keeps them.
+    damage_.MarkAll();
+    pack_damage_.Resize(width_, height_);
+}
+
+void PixelRenderer::SetExternalTarget(Color32* pixels) {
+    if (pixels == external_) {
+        return;
+    }
+    external_ = pixels;
+    Allocate();
+    damage_.Resize(width_, height_);
+    detile_damage_.Resize(width_, height_);
+    pack_damage_.Resize(width_, height_);
+}
+
+void PixelRenderer::SetOverdrawView(bool enabled) {
+    if (enabled == overdraw_view_) {
+        return;
+    }
+    overdraw_view_ = enabled;
+    if (enabled) {
+        ResetOverdraw();
+    } else {
+        write_counts_ = std::vector<uint16_t>();
+        heatmap_ = FramebufferVector<Color32>();
+    }
+    // What Pixels() shows changes everywhere.
+    damage_.MarkAll();
+}
+
+void PixelRenderer::ResetOverdraw() {
+    write_counts_.assign(static_cast<size_t>(width_) * static_cast<size_t>(height_), 0);
+    overdraw_ = OverdrawStats{};
+}
+
+void PixelRenderer::CountOverdraw(int y, int x0, int x1) {
+    uint16_t* counts = write_counts_.data() + static_cast<size_t>(y) * width_;
+    for (int x = x0; x < x1; ++x) {
+        overdraw_.covered += counts[x] == 0;
+        counts[x] += counts[x] != UINT16_MAX;
+    }
+    overdraw_.writes += static_cast<uint64_t>(x1 - x0);
+}
+
+void PixelRenderer::CountOverdrawPoints(const PixelCoord* coords, size_t count) {
+    const unsigned width = static_cast<unsigned>(width_);
+    const unsigned height = static_cast<unsigned>(height_);
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned x = static_cast<unsigned>(coords[i].x);
+        const unsigned y = static_cast<unsigned>(coords[i].y);
+        if (x < width && y < height) {
+            CountOverdraw(static_cast<int>(y), static_cast<int>(x), static_cast<int>(x) + 1);
+        } else {
+            ++overdraw_.clipped;
+        }
+    }
 }
 
-void PixelRenderer::Clear(const Color4f& color) {
-    Pixel rgba = ColorToPixel(color);
-    if (!clear_row_valid_ || !(clear_row_pixel_ == rgba) ||
-        clear_row_.size() != static_cast<size_t>(width_)) {
-        clear_row_.assign(static_cast<size_t>(width_), rgba);
-        clear_row_pixel_ = rgba;
-        clear_row_valid_ = true;
+// Storage is sized for the largest dimensions seen so far and only grows, so resizing within
+// them costs no allocation; rows keep the capacity's pitch, rounded up to whole cache lines.
+void PixelRenderer::Allocate() {
+    tiles_x_ = static_cast<size_t>((width_ + kTileMask) >> kTileShift);
+    tiles_y_ = static_cast<size_t>((height_ + kTileMask) >> kTileShift);
+    tile_pitch_ = static_cast<size_t>((capacity_width_ + kTileMask) >> kTileShift);
+    pitch_ = external_ ? width_ : PaddedPitch(capacity_width_);
+    size_t storage = static_cast<size_t>(pitch_) * static_cast<size_t>(capacity_height_);
+    if (layout_ == FramebufferLayout::Tiled) {
+        const size_t tile_rows = static_cast<size_t>((capacity_height_ + kTileMask) >> kTileShift);
+        storage = tile_pitch_ * tile_rows * kTilePixels;
+    }
+    if (layout_ == FramebufferLayout::Linear && external_) {
+        pixels_.clear();
+        pixels_.shrink_to_fit();
+        target_ = external_;
+    } else {
+        if (pixels_.size() < storage) {
+            pixels_.assign(storage, Color32{});
+        }
+        target_ = pixels_.data();
+    }
+    if (layout_ == FramebufferLayout::Linear || external_) {
+        linear_.clear();
+        linear_.shrink_to_fit();
     }
-    if (width_ <= 0 || height_ <= 0) {
+    AllocatePacked();
+    // Reused storage still holds old pixels, so every tile is owed a clear to the opaque
+    // black a new target starts as; tiles nothing draws over are filled by Pixels().
+    clear_pending_.assign(tiles_x_ * tiles_y_, 1);
+    pending_tiles_ = clear_pending_.size();
+    clear_color_ = Color32{};
+}
+
+void PixelRenderer::AllocatePacked() {
+    if (format_ == PixelFormat::RGBA8) {
+        packed_.clear();
+        packed_.shrink_to_fit();
         return;
     }
-    Pixel* dst = pixels_.data();
-    const size_t row_bytes = static_cast<size_t>(width_) * sizeof(Pixel);
-    for (int y = 0; y < height_; ++y) {
-        std::memcpy(dst, clear_row_.data(), row_bytes);
-        dst += width_;
+    const size_t bytes = static_cast<size_t>(pitch_) * static_cast<size_t>(capacity_height_) *
+                         BytesPerPixel(format_);
+    if (packed_.size() < bytes) {
+        packed_.resize(bytes);
     }
 }
 
-void PixelRenderer::PutPixel(int x, int y, const Color4f& color) {
+size_t PixelRenderer::Offset(int x, int y) const {
+    if (layout_ == FramebufferLayout::Tiled) {
+        return TiledOffset(static_cast<unsigned>(x), static_cast<unsigned>(y), tile_pitch_);
+    }
+    return static_cast<size_t>(y) * static_cast<size_t>(pitch_) + static_cast<size_t>(x);
+}
+
+// Calls fn(index, pixel) for every in-bounds coordinate and marks their bounds as drawn. The
+// layout branch sits outside the loop so both variants stay tight.
+template <typename Fn>
+void PixelRenderer::ForEachPoint(const PixelCoord* coords, size_t count, Fn&& fn) {
+    if (overdraw_view_) {
+        CountOverdrawPoints(coords, count);
+    }
+    // Unsigned compares fold the negative and upper bound checks into one test per axis.
+    const unsigned width = static_cast<unsigned>(width_);
+    const unsigned height = static_cast<unsigned>(height_);
+    unsigned min_x = width;
+    unsigned min_y = height;
+    unsigned max_x = 0;
+    unsigned max_y = 0;
+    auto grow = [&](unsigned x, unsigned y) {
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+    };
+    if (pending_tiles_ != 0) {
+        // Deferred clears under the points have to land before the points do.
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned x = static_cast<unsigned>(coords[i].x);
+            const unsigned y = static_cast<unsigned>(coords[i].y);
+            if (x < width && y < height) {
+                grow(x, y);
+            }
+        }
+        if (min_x > max_x) {
+            if (kRenderStats) {
+                stats_.pixels_rejected += count;
+            }
+            return;
+        }
+        ResolveRect(static_cast<int>(min_x), static_cast<int>(min_y), static_cast<int>(max_x) + 1,
+                    static_cast<int>(max_y) + 1, false);
+    }
+    Color32* dst = target_;
+    size_t written = 0;
+    if (layout_ == FramebufferLayout::Tiled) {
+        const size_t tile_pitch = tile_pitch_;
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned x = static_cast<unsigned>(coords[i].x);
+            const unsigned y = static_cast<unsigned>(coords[i].y);
+            if (x < width && y < height) {
+                fn(i, dst[TiledOffset(x, y, tile_pitch)]);
+                grow(x, y);
+                ++written;
+            }
+        }
+    } else {
+        const size_t pitch = static_cast<size_t>(pitch_);
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned x = static_cast<unsigned>(coords[i].x);
+            const unsigned y = static_cast<unsigned>(coords[i].y);
+            if (x < width && y < height) {
+                fn(i, dst[y * pitch + x]);
+                grow(x, y);
+                ++written;
+            }
+        }
+    }
+    if (kRenderStats) {
+        stats_.pixels_written += written;
+        stats_.pixels_rejected += count - written;
+    }
+    if (min_x <= max_x) {
+        MarkDrawn(static_cast<int>(min_x), static_cast<int>(min_y), static_cast<int>(max_x) + 1,
+                  static_cast<int>(max_y) + 1);
+    }
+}
+
+// Calls fn(dst, x, count) for each contiguous run of row y in [x0, x1), which must already be
+// clipped. Linear targets produce one run; tiled targets produce one run per tile.
+template <typename Fn> void PixelRenderer::ForEachRun(int y, int x0, int x1, Fn&& fn) {
+    if (layout_ == FramebufferLayout::Linear) {
+        fn(target_ + static_cast<size_t>(y) * pitch_ + x0, x0,
+           static_cast<size_t>(x1 - x0));
+        return;
+    }
+    const size_t row_base = static_cast<size_t>(y >> kTileShift) * tile_pitch_ * kTilePixels +
+                            (static_cast<size_t>(y & kTileMask) << kTileShift);
+    for (int x = x0; x < x1;) {
+        const int run_end = std::min(x1, (x | kTileMask) + 1);
+        Color32* dst = target_ + row_base +
+                       static_cast<size_t>(x >> kTileShift) * kTilePixels + (x & kTileMask);
+        fn(dst, x, static_cast<size_t>(run_end - x));
+        x = run_end;
+    }
+}
+
+void PixelRenderer::Detile() const {
+    // The linear copy persists between calls, so only tiles written since the last one need
+    // rewriting; Resize, SetLayout and SetExternalTarget mark everything.
+    if (!external_) {
+        linear_.resize(static_cast<size_t>(pitch_) * static_cast<size_t>(capacity_height_));
+    }
+    for (const PixelRect& rect : detile_damage_.Rects()) {
+        DetileRect(rect);
+    }
+    detile_damage_.Reset();
+}
+
+void PixelRenderer::DetileRect(const PixelRect& rect) const {
+    const int tx0 = rect.x >> kTileShift;
+    const int tx1 = (rect.x + rect.width + kTileMask) >> kTileShift;
+    const int y1 = rect.y + rect.height;
+    // Tiles are read in storage order so the source streams sequentially; each tile scatters
+    // kTileSize short rows into the linear image.
+    for (int band = rect.y & ~kTileMask; band < y1; band += kTileSize) {
+        const int rows = std::min(kTileSize, height_ - band);
+        const Color32* src = target_ +
+                             static_cast<size_t>(band >> kTileShift) * tile_pitch_ * kTilePixels +
+                             static_cast<size_t>(tx0) * kTilePixels;
+        Color32* dst = LinearTarget() + static_cast<size_t>(band) * pitch_ + (tx0 << kTileShift);
+        for (int tx = tx0; tx < tx1; ++tx) {
+            const int cols = std::min(kTileSize, width_ - (tx << kTileShift));
+            if (cols == kTileSize) {
+                for (int row = 0; row < rows; ++row) {
+                    // Fixed-size copies compile to a couple of vector moves.
+                    std::memcpy(dst + static_cast<size_t>(row) * pitch_, src + row * kTileSize,
+                                kTileSize * sizeof(Color32));
+                }
+            } else {
+                for (int row = 0; row < rows; ++row) {
+                    std::memcpy(dst + static_cast<size_t>(row) * pitch_, src + row * kTileSize,
+                                static_cast<size_t>(cols) * sizeof(Color32));
+                }
+            }
+            dst += kTileSize;
+            src += kTilePixels;
+        }
+    }
+}
+
+// Settles every tile still waiting on a clear. Pixels() is the only reader of the target, so
+// this is the last point a deferred clear can wait for.
+void PixelRenderer::ResolveClear() {
+    for (size_t ty = 0; ty < tiles_y_ && pending_tiles_ != 0; ++ty) {
+        ResolveTiles(0, tiles_x_, ty);
+    }
+}
+
+// Fills the pending tiles among [tx0, tx1) of tile row ty. Adjacent pending tiles are filled
+// together, which on a linear target turns kTileSize-pixel row pieces into longer runs.
+void PixelRenderer::ResolveTiles(size_t tx0, size_t tx1, size_t ty) {
+    uint8_t* row = clear_pending_.data() + ty * tiles_x_;
+    for (size_t tx = tx0; tx < tx1;) {
+        if (!row[tx]) {
+            ++tx;
+            continue;
+        }
+        size_t end = tx;
+        while (end < tx1 && row[end]) {
+            row[end++] = 0;
+        }
+        FillTiles(tx, end, ty);
+        pending_tiles_ -= end - tx;
+        tx = end;
+    }
+}
+
+void PixelRenderer::FillTiles(size_t tx0, size_t tx1, size_t ty) {
+    if (layout_ == FramebufferLayout::Tiled) {
+        // A band's tiles are adjacent in memory.
+        FillPixels(target_ + (ty * tile_pitch_ + tx0) * kTilePixels, (tx1 - tx0) * kTilePixels,
+                   clear_color_);
+        return;
+    }
+    const int x0 = static_cast<int>(tx0) << kTileShift;
+    const int x1 = std::min(static_cast<int>(tx1) << kTileShift, width_);
+    const int y0 = static_cast<int>(ty) << kTileShift;
+    const int y1 = std::min(y0 + kTileSize, height_);
+    Color32* dst = target_ + static_cast<size_t>(y0) * pitch_ + x0;
+    for (int y = y0; y < y1; ++y) {
+        FillPixels(dst, static_cast<size_t>(x1 - x0), clear_color_);
+        dst += pitch_;
+    }
+}
+
+// Must run before any write inside [x0, x1) x [y0, y1), which must already be clipped, so the
+// tiles there get any clear they are still owed. Every pending tile is filled once whether here
+// or in ResolveClear, so resolving by bounds rather than per pixel costs no extra writes. An
+// opaque write replaces every pixel of the region, so tiles entirely inside it skip the fill.
+void PixelRenderer::ResolveRect(int x0, int y0, int x1, int y1, bool opaque) {
+    if (pending_tiles_ == 0) {
+        return;
+    }
+    const size_t tx0 = static_cast<size_t>(x0 >> kTileShift);
+    const size_t tx1 = static_cast<size_t>(((x1 - 1) >> kTileShift) + 1);
+    const size_t ty0 = static_cast<size_t>(y0 >> kTileShift);
+    const size_t ty1 = static_cast<size_t>((y1 - 1) >> kTileShift);
+    // Tile columns lying wholly inside [x0, x1); the last one may be narrower at the edge.
+    const size_t covered_x0 = static_cast<size_t>((x0 + kTileMask) >> kTileShift);
+    const size_t covered_x1 = x1 == width_ ? tx1 : static_cast<size_t>(x1 >> kTileShift);
+    for (size_t ty = ty0; ty <= ty1 && pending_tiles_ != 0; ++ty) {
+        const int band = static_cast<int>(ty) << kTileShift;
+        if (opaque && band >= y0 && std::min(band + kTileSize, height_) <= y1) {
+            uint8_t* row = clear_pending_.data() + ty * tiles_x_;
+            for (size_t tx = covered_x0; tx < covered_x1; ++tx) {
+                pending_tiles_ -= row[tx];
+                row[tx] = 0;
+            }
+        }
+        ResolveTiles(tx0, tx1, ty);
+    }
+}
+
+// A clear to the color the rest of the target already holds only has to revisit what was drawn
+// since the previous one, which the damage tracker still has as a few rects. Their fills are
+// deferred to ResolveRect and ResolveClear.
+void PixelRenderer::ClearTiles(Color32 color) {
+    if (color == clear_color_) {
+        for (const PixelRect& rect : damage_.Drawn()) {
+            const size_t tx0 = static_cast<size_t>(rect.x >> kTileShift);
+            const size_t tx1 = static_cast<size_t>((rect.x + rect.width + kTileMask) >> kTileShift);
+            const size_t ty0 = static_cast<size_t>(rect.y >> kTileShift);
+            const size_t ty1 =
+                static_cast<size_t>((rect.y + rect.height + kTileMask) >> kTileShift);
+            for (size_t ty = ty0; ty < ty1; ++ty) {
+                uint8_t* row = clear_pending_.data() + ty * tiles_x_;
+                for (size_t tx = tx0; tx < tx1; ++tx) {
+                    pending_tiles_ += 1 - row[tx];
+                    row[tx] = 1;
+                }
+            }
+        }
+    } else {
+        std::fill(clear_pending_.begin(), clear_pending_.end(), uint8_t{1});
+        pending_tiles_ = clear_pending_.size();
+        clear_color_ = color;
+    }
+    // When most of the target needs the fill anyway, one contiguous pass beats resolving it
+    // tile by tile and lets large targets stream it, as Clear always did.
+    if (pending_tiles_ * 4 >= clear_pending_.size() * 3) {
+        FillVisible(color);
+        std::fill(clear_pending_.begin(), clear_pending_.end(), uint8_t{0});
+        pending_tiles_ = 0;
+    }
+}
+
+// Fills every visible pixel. Rows that are adjacent in storage are filled as one run, so
+// a target at its full capacity streams in a single pass.
+void PixelRenderer::FillVisible(Color32 color) {
+    size_t run = static_cast<size_t>(width_);
+    size_t stride = static_cast<size_t>(pitch_);
+    size_t runs = static_cast<size_t>(height_);
+    if (layout_ == FramebufferLayout::Tiled) {
+        run = tiles_x_ * kTilePixels;
+        stride = tile_pitch_ * kTilePixels;
+        runs = tiles_y_;
+    }
+    if (run == stride) {
+        run *= runs;
+        runs = 1;
+    }
+    const bool stream = run * runs * sizeof(Color32) >= kStreamingFillBytes;
+    Color32* dst = target_;
+    for (size_t i = 0; i < runs; ++i) {
+        if (stream) {
+            FillPixelsStreaming(dst, run, color);
+        } else {
+            FillPixels(dst, run, color);
+        }
+        dst += stride;
+    }
+    if (stream) {
+        StreamFence();
+    }
+}
+
+void PixelRenderer::Pack(const Color32* image) const {
+    const size_t bytes_per_pixel = BytesPerPixel(format_);
+    for (const PixelRect& rect : pack_damage_.Rects()) {
+        for (int y = rect.y; y < rect.y + rect.height; ++y) {
+            const size_t offset = static_cast<size_t>(y) * pitch_ + rect.x;
+            PackPixels(image + offset, packed_.data() + offset * bytes_per_pixel,
+                       static_cast<size_t>(rect.width), format_);
+        }
+    }
+    pack_damage_.Reset();
+}
+
+const uint8_t* PixelRenderer::Pixels() const {
+    if (overdraw_view_) {
+        heatmap_.resize(static_cast<size_t>(pitch_) * static_cast<size_t>(height_));
+        for (int y = 0; y < height_; ++y) {
+            const uint16_t* counts = write_counts_.data() + static_cast<size_t>(y) * width_;
+            Color32* dst = heatmap_.data() + static_cast<size_t>(y) * pitch_;
+            for (int x = 0; x < width_; ++x) {
+                dst[x] = kHeatmap[std::min<size_t>(counts[x], kHeatmapLevels - 1)];
+            }
+        }
+        return reinterpret_cast<const uint8_t*>(heatmap_.data());
+    }
+    const_cast<PixelRenderer*>(this)->ResolveClear();
+    const Color32* image = target_;
+    if (layout_ == FramebufferLayout::Tiled) {
+        Detile();
+        image = LinearTarget();
+    }
+    if (format_ == PixelFormat::RGBA8) {
+        return reinterpret_cast<const uint8_t*>(image);
+    }
+    Pack(image);
+    return packed_.data();
+}
+
+void PixelRenderer::Clear(Color32 color) { FillRect(0, 0, width_, height_, color); }
+
+void PixelRenderer::PutPixel(int x, int y, Color32 color, BlendMode blend) {
     if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+        CountClipped(1);
+        return;
+    }
+    CountPixel(x, y);
+    ResolveRect(x, y, x + 1, y + 1, false);
+    Color32& pixel = target_[Offset(x, y)];
+    pixel = blend == BlendMode::Replace ? color : BlendPixel(pixel, color, blend);
+    MarkDrawn(x, y, x + 1, y + 1);
+}
+
+void PixelRenderer::PutPixels(const PixelCoord* coords, size_t count, Color32 color,
+                              BlendMode blend) {
+    if (!coords || count == 0) {
+        return;
+    }
+    if (blend == BlendMode::SourceOver && color.A() == 255) {
+        blend = BlendMode::Replace;
+    } else if (blend != BlendMode::Replace && color.A() == 0) {
         return;
     }
-    Pixel rgba = ColorToPixel(color);
-    size_t index = static_cast<size_t>(y * width_ + x);
-    pixels_[index] = rgba;
+    if (blend == BlendMode::Replace) {
+        ForEachPoint(coords, count, [color](size_t, Color32& pixel) { pixel = color; });
+        return;
+    }
+    ForEachPoint(coords, count, [color, blend](size_t, Color32& pixel) {
+        pixel = BlendPixel(pixel, color, blend);
+    });
 }
+
+void PixelRenderer::PutPixels(const PixelCoord* coords, const Color32* colors, size_t count,
+                              BlendMode blend) {
+    if (!coords || !colors || count == 0) {
+        return;
+    }
+    if (blend == BlendMode::Replace) {
+        ForEachPoint(coords, count, [colors](size_t i, Color32& pixel) { pixel = colors[i]; });
+        return;
+    }
+    ForEachPoint(coords, count, [colors, blend](size_t i, Color32& pixel) {
+        pixel = BlendPixel(pixel, colors[i], blend);
+    });
+}
+
+void PixelRenderer::PutSpan(int x, int y, const Color32* colors, size_t count, BlendMode blend) {
+    if (!colors || count == 0) {
+        return;
+    }
+    if (y < 0 || y >= height_) {
+        CountClipped(count);
+        return;
+    }
+    long long begin = x;
+    long long end = begin + static_cast<long long>(count);
+    if (begin < 0) {
+        colors += -begin;
+        begin = 0;
+    }
+    end = std::min<long long>(end, width_);
+    if (begin >= end) {
+        CountClipped(count);
+        return;
+    }
+    const int x0 = static_cast<int>(begin);
+    const int x1 = static_cast<int>(end);
+    CountClipped(count - static_cast<size_t>(x1 - x0));
+    CountSpan(y, x0, x1);
+    ResolveRect(x0, y, x1, y + 1, blend == BlendMode::Replace);
+    ForEachRun(y, x0, x1, [colors, x0, blend](Color32* dst, int run_x, size_t n) {
+        BlendSpan(dst, colors + (run_x - x0), n, blend);
+    });
+    MarkDrawn(x0, y, x1, y + 1);
+}
+
+void PixelRenderer::FillSpan(int x, int y, int width, Color32 color, BlendMode blend) {
+    if (width <= 0) {
+        return;
+    }
+    if (y < 0 || y >= height_) {
+        CountClipped(static_cast<uint64_t>(width));
+        return;
+    }
+    int x0 = std::max(x, 0);
+    int x1 = static_cast<int>(std::min<long long>(static_cast<long long>(x) + width, width_));
+    if (x0 >= x1) {
+        CountClipped(static_cast<uint64_t>(width));
+        return;
+    }
+    CountClipped(static_cast<uint64_t>(width - (x1 - x0)));
+    CountSpan(y, x0, x1);
+    ResolveRect(x0, y, x1, y + 1, blend == BlendMode::Replace);
+    ForEachRun(y, x0, x1,
+               [color, blend](Color32* dst, int, size_t n) { BlendFill(dst, n, color, blend); });
+    MarkDrawn(x0, y, x1, y + 1);
+}
+
+void PixelRenderer::FillRect(int x, int y, int width, int height, Color32 color,
+                             BlendMode blend) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    int x0 = std::max(x, 0);
+    int y0 = std::max(y, 0);
+    int x1 = static_cast<int>(std::min<long long>(static_cast<long long>(x) + width, width_));
+    int y1 = static_cast<int>(std::min<long long>(static_cast<long long>(y) + height, height_));
+    const uint64_t area = static_cast<uint64_t>(width) * static_cast<uint64_t>(height);
+    if (x0 >= x1 || y0 >= y1) {
+        CountClipped(area);
+        return;
+    }
+
+    if (blend == BlendMode::SourceOver && color.A() == 255) {
+        blend = BlendMode::Replace;
+    }
+    if (blend == BlendMode::Replace && x0 == 0 && y0 == 0 && x1 == width_ && y1 == height_) {
+        // ClearTiles reads what was drawn since the last clear before MarkCleared drops it.
+        ClearTiles(color);
+        MarkCleared(color);
+        // A clear starts the count over, like a new frame.
+        if (overdraw_view_) {
+            ResetOverdraw();
+        }
+        return;
+    }
+    CountClipped(area - static_cast<uint64_t>(x1 - x0) * static_cast<uint64_t>(y1 - y0));
+    for (int row = y0; row < y1; ++row) {
+        CountSpan(row, x0, x1);
+    }
+    MarkDrawn(x0, y0, x1, y1);
+    // Opaque fills drop the pending clear of tiles they cover completely. Blends read the
+    // target, so they resolve pending clears a tile band at a time, just ahead of the band.
+    const bool opaque = blend == BlendMode::Replace;
+    if (opaque) {
+        ResolveRect(x0, y0, x1, y1, true);
+    }
+    const size_t span = static_cast<size_t>(x1 - x0);
+    const size_t rows = static_cast<size_t>(y1 - y0);
+    const bool stream =
+        blend == BlendMode::Replace && span * rows * sizeof(Color32) >= kStreamingFillBytes;
+
+    if (layout_ == FramebufferLayout::Tiled) {
+        // Walk tile by tile. Rows of a tile are adjacent in memory, so wherever the rect covers
+        // a tile's full width its rows inside that band form one run.
+        for (int band = y0; band < y1;) {
+            const int band_end = std::min(y1, (band | kTileMask) + 1);
+            const size_t band_rows = static_cast<size_t>(band_end - band);
+            if (!opaque) {
+                ResolveRect(x0, band, x1, band_end, false);
+            }
+            Color32* band_base =
+                target_ + static_cast<size_t>(band >> kTileShift) * tile_pitch_ * kTilePixels +
+                (static_cast<size_t>(band & kTileMask) << kTileShift);
+            for (int x = x0; x < x1;) {
+                const int run_end = std::min(x1, (x | kTileMask) + 1);
+                const size_t run = static_cast<size_t>(run_end - x);
+                Color32* dst = band_base + static_cast<size_t>(x >> kTileShift) * kTilePixels +
+                               (x & kTileMask);
+                if (run == static_cast<size_t>(kTileSize)) {
+                    BlendFill(dst, run * band_rows, color, blend);
+                } else {
+                    for (size_t row = 0; row < band_rows; ++row) {
+                        BlendFill(dst + row * kTileSize, run, color, blend);
+                    }
+                }
+                x = run_end;
+            }
+            band = band_end;
+        }
+        return;
+    }
+
+    Color32* dst = target_ + static_cast<size_t>(y0) * pitch_ + x0;
+    if (!opaque) {
+        for (int band = y0; band < y1;) {
+            const int band_end = std::min(y1, (band | kTileMask) + 1);
+            ResolveRect(x0, band, x1, band_end, false);
+            for (int row = band; row < band_end; ++row) {
+                BlendFill(dst, span, color, blend);
+                dst += pitch_;
+            }
+            band = band_end;
+        }
+        return;
+    }
+
+    // Full-width rects are one contiguous run, so the kernel only aligns once.
+    if (span == static_cast<size_t>(pitch_)) {
+        if (stream) {
+            FillPixelsStreaming(dst, span * rows, color);
+            StreamFence();
+        } else {
+            FillPixels(dst, span * rows, color);
+        }
+        return;
+    }
+
+    for (size_t row = 0; row < rows; ++row) {
+        if (stream) {
+            FillPixelsStreaming(dst, span, color);
+        } else {
+            FillPixels(dst, span, color);
+        }
+        dst += pitch_;
+    }
+    if (stream) {
+        StreamFence();
+    }
+}
+
+void PixelRenderer::FillTriangle(const ScreenVertex& v0, const ScreenVertex& v1,
+                                 const ScreenVertex& v2, Color32 color, BlendMode blend) {
+    if (blend == BlendMode::SourceOver && color.A() == 255) {
+        blend = BlendMode::Replace;
+    } else if (blend != BlendMode::Replace && color.A() == 0) {
+        return;
+    }
+    const RasterClip target{0, 0, width_, height_};
+    spans_.clear();
+    if (!depth_.Enabled()) {
+        RasterizeTriangle(v0, v1, v2, target, spans_);
+        FillCoverage(spans_, color, blend);
+        return;
+    }
+
+    RasterClip bounds;
+    DepthPlane plane;
+    if (!TriangleBounds(v0, v1, v2, target, &bounds) ||
+        !DepthPlane::FromTriangle(v0, v1, v2, &plane)) {
+        return;
+    }
+    // Whole-triangle reject: nothing in its bounds is farther than its nearest vertex.
+    if (depth_.Occluded(bounds.x0, bounds.y0, bounds.x1, bounds.y1,
+                        std::min({v0.z, v1.z, v2.z}))) {
+        return;
+    }
+    RasterizeTriangle(v0, v1, v2, target, spans_);
+    visible_.clear();
+    for (const CoverageSpan& span : spans_) {
+        depth_.TestSpan(span, plane, visible_);
+    }
+    depth_.RefreshHiZ(bounds.x0, bounds.y0, bounds.x1, bounds.y1);
+    FillCoverage(visible_, color, blend);
+}
+
+void PixelRenderer::FillCircle(float cx, float cy, float radius, Color32 color, BlendMode blend) {
+    FillEllipse(cx, cy, radius, radius, color, blend);
+}
+
+void PixelRenderer::FillEllipse(float cx, float cy, float rx, float ry, Color32 color,
+                                BlendMode blend) {
+    if (blend == BlendMode::SourceOver && color.A() == 255) {
+        blend = BlendMode::Replace;
+    } else if (blend != BlendMode::Replace && color.A() == 0) {
+        return;
+    }
+    spans_.clear();
+    RasterizeEllipse(cx, cy, rx, ry, RasterClip{0, 0, width_, height_}, spans_);
+    FillCoverage(spans_, color, blend);
+}
+
+void PixelRenderer::StrokeRing(float cx, float cy, float inner_radius, float outer_radius,
+                               Color32 color, BlendMode blend) {
+    if (blend == BlendMode::SourceOver && color.A() == 255) {
+        blend = BlendMode::Replace;
+    } else if (blend != BlendMode::Replace && color.A() == 0) {
+        return;
+    }
+    spans_.clear();
+    RasterizeRing(cx, cy, inner_radius, outer_radius, RasterClip{0, 0, width_, height_}, spans_);
+    FillCoverage(spans_, color, blend);
+}
+
+void PixelRenderer::DrawLine(const LineSegment& line, Color32 color, BlendMode blend,
+                             LineMode mode) {
+    DrawLines(&line, 1, color, blend, mode);
+}
+
+void PixelRenderer::DrawLines(const LineSegment* lines, size_t count, Color32 color,
+                              BlendMode blend, LineMode mode) {
+    if (!lines || count == 0) {
+        return;
+    }
+    if (kRenderStats) {
+        stats_.lines_drawn += count;
+    }
+    if (blend == BlendMode::SourceOver && color.A() == 255 && mode == LineMode::Aliased) {
+        blend = BlendMode::Replace;
+    } else if (blend != BlendMode::Replace && color.A() == 0) {
+        return;
+    }
+    const RasterClip target{0, 0, width_, height_};
+    if (mode == LineMode::Aliased) {
+        spans_.clear();
+        for (size_t i = 0; i < count; ++i) {
+            RasterizeLine(lines[i], target, target, spans_);
+        }
+        FillCoverage(spans_, color, blend);
+        return;
+    }
+    coverage_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        RasterizeLineAA(lines[i], target, target, coverage_);
+    }
+    if (coverage_.empty()) {
+        return;
+    }
+    int x0 = width_;
+    int y0 = height_;
+    int x1 = 0;
+    int y1 = 0;
+    for (const CoveragePixel& covered : coverage_) {
+        x0 = std::min(x0, covered.x);
+        y0 = std::min(y0, covered.y);
+        x1 = std::max(x1, covered.x + 1);
+        y1 = std::max(y1, covered.y + 1);
+    }
+    ResolveRect(x0, y0, x1, y1, false);
+    for (const CoveragePixel& covered : coverage_) {
+        CountPixel(covered.x, covered.y);
+        Color32& pixel = target_[Offset(covered.x, covered.y)];
+        pixel = BlendCoverage(pixel, color, covered.coverage, blend);
+    }
+    MarkDrawn(x0, y0, x1, y1);
+}
+
+void PixelRenderer::BlitTransformed(const Image& image, const ImageTransform& transform,
+                                    ImageFilter filter, BlendMode blend) {
+    ImageBlit blit;
+    if (!blit.Setup(image, transform, width_, height_)) {
+        return;
+    }
+    const PixelRect& bounds = blit.Bounds();
+    const int x_end = bounds.x + bounds.width;
+    const int y_end = bounds.y + bounds.height;
+    const bool opaque = blend == BlendMode::Replace;
+    ResolveRect(bounds.x, bounds.y, x_end, y_end, opaque && blit.CoversBounds());
+    for (int y = bounds.y; y < y_end; ++y) {
+        int x0 = 0;
+        int x1 = 0;
+        if (!blit.RowSpan(y, 0, width_, &x0, &x1)) {
+            continue;
+        }
+        CountSpan(y, x0, x1);
+        if (opaque) {
+            // Replace samples straight into the target, one run per tile when tiled.
+            ForEachRun(y, x0, x1, [&](Color32* dst, int run_x, size_t n) {
+                blit.Sample(image, filter, run_x, y, dst, n);
+            });
+            continue;
+        }
+        blit_row_.resize(static_cast<size_t>(x1 - x0));
+        blit.Sample(image, filter, x0, y, blit_row_.data(), blit_row_.size());
+        const Color32* row = blit_row_.data();
+        ForEachRun(y, x0, x1, [row, x0, blend](Color32* dst, int run_x, size_t n) {
+            BlendSpan(dst, row + (run_x - x0), n, blend);
+        });
+    }
+    MarkDrawn(bounds.x, bounds.y, x_end, y_end);
+}
+
+void PixelRenderer::FillCoverage(const std::vector<CoverageSpan>& spans, Color32 color,
+                                 BlendMode blend) {
+    if (spans.empty()) {
+        return;
+    }
+    int x0 = width_;
+    int y0 = height_;
+    int x1 = 0;
+    int y1 = 0;
+    for (const CoverageSpan& span : spans) {
+        x0 = std::min(x0, span.x);
+        y0 = std::min(y0, span.y);
+        x1 = std::max(x1, span.x + span.count);
+        y1 = std::max(y1, span.y + 1);
+    }
+    ResolveRect(x0, y0, x1, y1, false);
+    for (const CoverageSpan& span : spans) {
+        CountSpan(span.y, span.x, span.x + span.count);
+        if (span.count == 1) {
+            // Steep lines produce one-pixel spans; skip the kernel dispatch for them.
+            Color32& pixel = target_[Offset(span.x, span.y)];
+            pixel = blend == BlendMode::Replace ? color : BlendPixel(pixel, color, blend);
+            continue;
+        }
+        const int end = span.x + span.count;
+        ForEachRun(span.y, span.x, end, [color, blend](Color32* dst, int, size_t n) {
+            BlendFill(dst, n, color, blend);
+        });
+    }
+    MarkDrawn(x0, y0, x1, y1);
+}
+
+void PixelRenderer::MarkDrawn(int x0, int y0, int x1, int y1) {
+    damage_.MarkDrawn(x0, y0, x1, y1);
+    if (layout_ == FramebufferLayout::Tiled) {
+        detile_damage_.MarkDrawn(x0, y0, x1, y1);
+    }
+    if (format_ != PixelFormat::RGBA8) {
+        pack_damage_.MarkDrawn(x0, y0, x1, y1);
+    }
+}
+
+void PixelRenderer::MarkCleared(Color32 color) {
+    damage_.MarkCleared(color);
+    if (layout_ == FramebufferLayout::Tiled) {
+        detile_damage_.MarkCleared(color);
+    }
+    if (format_ != PixelFormat::RGBA8) {
+        pack_damage_.MarkCleared(color);
+    }
+}
+
+void PixelRenderer::SetDepthFormat(DepthFormat format) { depth_.SetFormat(format); }
+
+void PixelRenderer::ClearDepth(float depth) { depth_.Clear(depth); }
@@ -1,44 +1,202 @@
 #pragma once
 
 #include "engine/core/IRenderer.h"
+#include "engine/render/DamageTracker.h"
+#include "engine/render/DepthBuffer.h"
+#include "engine/render/FramebufferAllocator.h"
+#include "engine/render/LineRaster.h"
+#include "engine/render/ShapeRaster.h"
+#include "engine/render/TriangleRaster.h"
 
 #include <cstdint>
 #include <vector>
 
+// Storage order of the render target. Tiled keeps each kTileSize x kTileSize block contiguous,
+// so scattered points and steep lines touch a handful of cache lines instead of one line per
+// row; Pixels() then returns a row-major copy for the presenters.
+enum class FramebufferLayout {
+    Linear,
+    Tiled,
+};
+
+// Pixel writes since the last full-target clear, counted while the overdraw view is on.
+struct OverdrawStats {
+    // Writes that landed in the target, including repeated writes to one pixel.
+    uint64_t writes = 0;
+    // Pixels of points, spans and rects that fell outside the target. Triangles, shapes, lines
+    // and blits are clipped before they produce pixels, so they never count here.
+    uint64_t clipped = 0;
+    // Distinct pixels written at least once; writes / covered is the overdraw ratio.
+    uint64_t covered = 0;
+};
+
 class PixelRenderer : public IRenderer {
   public:
+    static constexpr int kTileSize = 8;
+
     PixelRenderer(int width, int height);
 
     void Resize(int width, int height) override;
-    void Clear(const Color4f& color) override;
-    void PutPixel(int x, int y, const Color4f& color) override;
+    void Clear(Color32 color) override;
+    void PutPixel(int x, int y, Color32 color, BlendMode blend = BlendMode::Replace) override;
+    void PutPixels(const PixelCoord* coords, size_t count, Color32 color,
+                   BlendMode blend = BlendMode::Replace) override;
+    void PutPixels(const PixelCoord* coords, const Color32* colors, size_t count,
+                   BlendMode blend = BlendMode::Replace) override;
+    void PutSpan(int x, int y, const Color32* colors, size_t count,
+                 BlendMode blend = BlendMode::Replace) override;
+    void FillSpan(int x, int y, int width, Color32 color,
+                  BlendMode blend = BlendMode::Replace) override;
+    void FillRect(int x, int y, int width, int height, Color32 color,
+                  BlendMode blend = BlendMode::Replace) override;
+    void FillTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2,
+                      Color32 color, BlendMode blend = BlendMode::Replace) override;
+    void FillCircle(float cx, float cy, float radius, Color32 color,
+                    BlendMode blend = BlendMode::Replace) override;
+    void FillEllipse(float cx, float cy, float rx, float ry, Color32 color,
+                     BlendMode blend = BlendMode::Replace) override;
+    void StrokeRing(float cx, float cy, float inner_radius, float outer_radius, Color32 color,
+                    BlendMode blend = BlendMode::Replace) override;
+    void DrawLine(const LineSegment& line, Color32 color, BlendMode blend = BlendMode::Replace,
+                  LineMode mode = LineMode::Aliased) override;
+    void DrawLines(const LineSegment* lines, size_t count, Color32 color,
+                   BlendMode blend = BlendMode::Replace,
+                   LineMode mode = LineMode::Aliased) override;
+    void BlitTransformed(const Image& image, const ImageTransform& transform,
+                         ImageFilter filter = ImageFilter::Bilinear,
+                         BlendMode blend = BlendMode::Replace) override;
+
+    void SetDepthFormat(DepthFormat format) override;
+    DepthFormat GetDepthFormat() const override { return depth_.Format(); }
+    void ClearDepth(float depth = 1.0f) override;
 
     int Width() const override { return width_; }
     int Height() const override { return height_; }
+    int Pitch() const override { return pitch_; }
+    PixelFormat Format() const override { return format_; }
+    const uint8_t* Pixels() const override;
+    bool ClearedTo(Color32* color) const override { return damage_.ClearedTo(color); }
+    const std::vector<PixelRect>& Damage() const override { return damage_.Rects(); }
+    void ResetDamage() override { damage_.Reset(); }
+    const RenderStats& Stats() const override { return stats_; }
+    void ResetStats() override { stats_ = RenderStats{}; }
 
-    const uint8_t* Pixels() const override {
-        return reinterpret_cast<const uint8_t*>(pixels_.data());
-    }
+    // Switching layouts reallocates the target; its contents are discarded.
+    void SetLayout(FramebufferLayout layout);
+    FramebufferLayout Layout() const { return layout_; }
+    // Drawing stays RGBA8; Pixels() packs the regions drawn since its previous call into the
+    // output format. Changing it keeps the target's contents.
+    void SetOutputFormat(PixelFormat format);
+
+    // Row-major Width() x Height() storage that Pixels() should return, owned by the caller
+    // (e.g. a presenter's mapped upload buffer): a linear target renders straight into it and a
+    // tiled target detiles into it. Its rows are Width() pixels apart. The contents are
+    // discarded when the target changes. Resize keeps it attached, so after a resize the caller
+    // attaches one of the new size, or nullptr for owned storage, before drawing.
+    void SetExternalTarget(Color32* pixels);
+    Color32* ExternalTarget() const { return external_; }
+
+    // Instrumentation: counts the writes to every pixel between full-target clears, and makes
+    // Pixels() return those counts as an RGBA8 heatmap (dark blue for one write through green
+    // and yellow to red and white for eight or more) while drawing carries on underneath.
+    void SetOverdrawView(bool enabled);
+    bool OverdrawView() const { return overdraw_view_; }
+    const OverdrawStats& Overdraw() const { return overdraw_; }
 
   private:
-    struct Pixel {
-        uint8_t r = 0;
-        uint8_t g = 0;
-        uint8_t b = 0;
-        uint8_t a = 255;
-
-        bool operator==(const Pixel& other) const {
-            return r == other.r && g == other.g && b == other.b && a == other.a;
+    size_t Offset(int x, int y) const;
+    Color32* LinearTarget() const { return external_ ? external_ : linear_.data(); }
+    void Allocate();
+    void AllocatePacked();
+    void Detile() const;
+    void Pack(const Color32* image) const;
+    void ResolveClear();
+    void FillVisible(Color32 color);
+    void ClearTiles(Color32 color);
+    void ResolveTiles(size_t tx0, size_t tx1, size_t ty);
+    void FillTiles(size_t tx0, size_t tx1, size_t ty);
+    void ResolveRect(int x0, int y0, int x1, int y1, bool opaque);
+    void DetileRect(const PixelRect& rect) const;
+    void MarkDrawn(int x0, int y0, int x1, int y1);
+    void MarkCleared(Color32 color);
+    void FillCoverage(const std::vector<CoverageSpan>& spans, Color32 color, BlendMode blend);
+    void ResetOverdraw();
+    // Adds a write to each pixel of row y in [x0, x1), which must already be clipped, to the
+    // overdraw counts.
+    void CountOverdraw(int y, int x0, int x1);
+    void CountOverdrawPoints(const PixelCoord* coords, size_t count);
+    // Count a clipped run or pixel toward Stats() and, when it is on, the overdraw view.
+    void CountSpan(int y, int x0, int x1) {
+        if (kRenderStats) {
+            ++stats_.spans_filled;
+            stats_.pixels_written += static_cast<uint64_t>(x1 - x0);
         }
-    };
-
-    static Pixel ColorToPixel(const Color4f& color);
+        if (overdraw_view_) {
+            CountOverdraw(y, x0, x1);
+        }
+    }
+    void CountPixel(int x, int y) {
+        if (kRenderStats) {
+            ++stats_.pixels_written;
+        }
+        if (overdraw_view_) {
+            CountOverdraw(y, x, x + 1);
+        }
+    }
+    void CountClipped(uint64_t count) {
+        if (kRenderStats) {
+            stats_.pixels_rejected += count;
+        }
+        if (overdraw_view_) {
+            overdraw_.clipped += count;
+        }
+    }
+    template <typename Fn> void ForEachPoint(const PixelCoord* coords, size_t count, Fn&& fn);
+    template <typename Fn> void ForEachRun(int y, int x0, int x1, Fn&& fn);
 
     int width_ = 0;
     int height_ = 0;
+    FramebufferLayout layout_ = FramebufferLayout::Linear;
+    // Owned storage covers capacity_width_ x capacity_height_; rows of the row-major image are
+    // pitch_ pixels apart (padded to whole cache lines) and tile rows of the tiled one
+    // tile_pitch_ tiles apart.
+    int capacity_width_ = 0;
+    int capacity_height_ = 0;
+    int pitch_ = 0;
+    size_t tile_pitch_ = 0;
+    size_t tiles_x_ = 0;
+    size_t tiles_y_ = 0;
 
-    std::vector<Pixel> pixels_;
-    std::vector<Pixel> clear_row_;
-    Pixel clear_row_pixel_{};
-    bool clear_row_valid_ = false;
+    FramebufferVector<Color32> pixels_;
+    // Where draws land: pixels_, or external_ for a linear target with one attached.
+    Color32* target_ = nullptr;
+    Color32* external_ = nullptr;
+    // Clear is deferred per kTileSize tile in either layout: a nonzero entry marks a tile that
+    // is owed clear_color_ before its next read or write.
+    std::vector<uint8_t> clear_pending_;
+    size_t pending_tiles_ = 0;
+    Color32 clear_color_;
+    std::vector<CoverageSpan> spans_;
+    std::vector<CoverageSpan> visible_;
+    std::vector<CoveragePixel> coverage_;
+    // Samples of one blit row, staged for blending.
+    std::vector<Color32> blit_row_;
+    DepthBuffer depth_;
+    DamageTracker damage_;
+    // Row-major copy of a tiled target, brought up to date by Pixels().
+    mutable FramebufferVector<Color32> linear_;
+    // Tiles written since linear_ was last brought up to date.
+    mutable DamageTracker detile_damage_;
+    PixelFormat format_ = PixelFormat::RGBA8;
+    // The row-major image in format_ when that is not RGBA8, pitch_ pixels per row.
+    mutable FramebufferVector<uint8_t> packed_;
+    // Regions written since packed_ was last brought up to date.
+    mutable DamageTracker pack_damage_;
+    RenderStats stats_;
+    bool overdraw_view_ = false;
+    OverdrawStats overdraw_;
+    // Writes per pixel since the last full clear, width_ per row; saturates.
+    std::vector<uint16_t> write_counts_;
+    // The overdraw heatmap Pixels() returns, pitch_ pixels per row.
+    mutable FramebufferVector<Color32> heatmap_;
 };
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// One covered run of a row: pixels [x, x + count) of row y.
+struct CoverageSpan {
+    int y = 0;
+    int x = 0;
+    int count = 0;
+};
+
+// One partially covered pixel; coverage 255 is fully covered.
+struct CoveragePixel {
+    int x = 0;
+    int y = 0;
+    uint8_t coverage = 0;
+};
+
+// Half-open clip rect in pixels.
+struct RasterClip {
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+};
@@ -0,0 +1,91 @@
+#include "engine/render/ShapeRaster.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+bool ValidShape(float cx, float cy, float rx, float ry) {
+    return std::isfinite(cx) && std::isfinite(cy) && std::isfinite(rx) && std::isfinite(ry) &&
+           rx > 0.0f && ry > 0.0f;
+}
+
+// Half-width of the ellipse at vertical offset dy from its center; negative when the row
+// misses it.
+double HalfWidth(double dy, double rx, double ry) {
+    const double t = 1.0 - (dy * dy) / (ry * ry);
+    return t < 0.0 ? -1.0 : rx * std::sqrt(t);
+}
+
+// Appends pixels first..last (inclusive) of row y, clipped. The range stays in double until
+// it is clamped so huge shapes cannot overflow the int conversion.
+void AppendSpan(int y, double first, double last, const RasterClip& clip,
+                std::vector<CoverageSpan>& spans) {
+    first = std::max(first, static_cast<double>(clip.x0));
+    last = std::min(last, static_cast<double>(clip.x1 - 1));
+    if (first > last) {
+        return;
+    }
+    const int x0 = static_cast<int>(first);
+    const int x1 = static_cast<int>(last);
+    spans.push_back({y, x0, x1 - x0 + 1});
+}
+} // namespace
+
+bool EllipseBounds(float cx, float cy, float rx, float ry, const RasterClip& clip,
+                   RasterClip* out) {
+    if (!ValidShape(cx, cy, rx, ry)) {
+        return false;
+    }
+    // Pixels whose centers can fall inside [c - r, c + r].
+    const double x0 = std::ceil(static_cast<double>(cx) - rx - 0.5);
+    const double x1 = std::floor(static_cast<double>(cx) + rx - 0.5) + 1.0;
+    const double y0 = std::ceil(static_cast<double>(cy) - ry - 0.5);
+    const double y1 = std::floor(static_cast<double>(cy) + ry - 0.5) + 1.0;
+    out->x0 = static_cast<int>(std::max(x0, static_cast<double>(clip.x0)));
+    out->y0 = static_cast<int>(std::max(y0, static_cast<double>(clip.y0)));
+    out->x1 = static_cast<int>(std::min(x1, static_cast<double>(clip.x1)));
+    out->y1 = static_cast<int>(std::min(y1, static_cast<double>(clip.y1)));
+    return out->x0 < out->x1 && out->y0 < out->y1;
+}
+
+void RasterizeEllipse(float cx, float cy, float rx, float ry, const RasterClip& clip,
+                      std::vector<CoverageSpan>& spans) {
+    RasterClip bounds;
+    if (!EllipseBounds(cx, cy, rx, ry, clip, &bounds)) {
+        return;
+    }
+    const double center_x = static_cast<double>(cx) - 0.5;
+    for (int y = bounds.y0; y < bounds.y1; ++y) {
+        const double half = HalfWidth(y + 0.5 - cy, rx, ry);
+        if (half >= 0.0) {
+            AppendSpan(y, std::ceil(center_x - half), std::floor(center_x + half), clip, spans);
+        }
+    }
+}
+
+void RasterizeRing(float cx, float cy, float inner_radius, float outer_radius,
+                   const RasterClip& clip, std::vector<CoverageSpan>& spans) {
+    RasterClip bounds;
+    if (!std::isfinite(inner_radius) || inner_radius >= outer_radius ||
+        !EllipseBounds(cx, cy, outer_radius, outer_radius, clip, &bounds)) {
+        return;
+    }
+    const double center_x = static_cast<double>(cx) - 0.5;
+    for (int y = bounds.y0; y < bounds.y1; ++y) {
+        const double dy = y + 0.5 - cy;
+        const double outer = HalfWidth(dy, outer_radius, outer_radius);
+        if (outer < 0.0) {
+            continue;
+        }
+        const double inner = inner_radius > 0.0f ? HalfWidth(dy, inner_radius, inner_radius) : -1.0;
+        if (inner < 0.0) {
+            AppendSpan(y, std::ceil(center_x - outer), std::floor(center_x + outer), clip, spans);
+            continue;
+        }
+        // Centers exactly on the inner circle belong to the disc, not the ring.
+        AppendSpan(y, std::ceil(center_x - outer), std::ceil(center_x - inner) - 1.0, clip,
+                   spans);
+        AppendSpan(y, std::floor(center_x + inner) + 1.0, std::floor(center_x + outer), clip,
+                   spans);
+    }
+}
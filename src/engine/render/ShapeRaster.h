@@ -0,0 +1,25 @@
+#pragma once
+
+#include "engine/render/RasterCoverage.h"
+
+#include <vector>
+
+// Scanline rasterizers for conics. Each covered row is solved directly for its span extents,
+// so a shape costs one square root and at most two spans per row regardless of its area.
+// Pixels are covered when their center (x + 0.5, y + 0.5) lies inside the shape, matching
+// the triangle rasterizer.
+
+// Pixel bounds of the axis-aligned ellipse, clipped; false when nothing inside clip can be
+// covered. Non-positive or non-finite radii cover nothing.
+bool EllipseBounds(float cx, float cy, float rx, float ry, const RasterClip& clip,
+                   RasterClip* out);
+
+// Pixels with ((px - cx) / rx)^2 + ((py - cy) / ry)^2 <= 1.
+void RasterizeEllipse(float cx, float cy, float rx, float ry, const RasterClip& clip,
+                      std::vector<CoverageSpan>& spans);
+
+// Pixels with inner_radius^2 < d^2 <= outer_radius^2, where d is the distance to the center:
+// the complement of a disc of inner_radius within a disc of outer_radius, so a ring drawn
+// around a disc of the same inner radius neither overlaps nor leaves a gap.
+void RasterizeRing(float cx, float cy, float inner_radius, float outer_radius,
+                   const RasterClip& clip, std::vector<CoverageSpan>& spans);
@@ -0,0 +1,239 @@
+#include "engine/render/SupersampledRenderer.h"
+
+#include "engine/render/PixelKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+// Scales a pixel coordinate or extent to samples. Anything past this limit is off the target
+// either way, so clamping keeps the product from overflowing without changing what is drawn.
+int ToSamples(int value, int factor) {
+    constexpr long long kLimit = 1 << 30;
+    const long long scaled = static_cast<long long>(value) * factor;
+    return static_cast<int>(std::clamp(scaled, -kLimit, kLimit));
+}
+
+int DivideDown(int value, int factor) {
+    return value >= 0 ? value / factor : -((-value + factor - 1) / factor);
+}
+
+int DivideUp(int value, int factor) { return -DivideDown(-value, factor); }
+} // namespace
+
+SupersampledRenderer::SupersampledRenderer(std::unique_ptr<IRenderer> inner, int factor)
+    : inner_(std::move(inner)), factor_(std::max(1, factor)) {
+    Resize(inner_->Width(), inner_->Height());
+}
+
+void SupersampledRenderer::Resize(int width, int height) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    inner_->Resize(width_ * factor_, height_ * factor_);
+    pitch_ = PaddedPitch(width_);
+    pixels_.resize(static_cast<size_t>(pitch_) * static_cast<size_t>(height_));
+    unresolved_.Resize(width_ * factor_, height_ * factor_);
+    stale_ = true;
+}
+
+void SupersampledRenderer::Clear(Color32 color) {
+    inner_->Clear(color);
+    stale_ = true;
+}
+
+void SupersampledRenderer::PutPixel(int x, int y, Color32 color, BlendMode blend) {
+    inner_->FillRect(ToSamples(x, factor_), ToSamples(y, factor_), factor_, factor_, color, blend);
+    stale_ = true;
+}
+
+void SupersampledRenderer::PutPixels(const PixelCoord* coords, size_t count, Color32 color,
+                                     BlendMode blend) {
+    points_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const int x = ToSamples(coords[i].x, factor_);
+        const int y = ToSamples(coords[i].y, factor_);
+        for (int sy = 0; sy < factor_; ++sy) {
+            for (int sx = 0; sx < factor_; ++sx) {
+                points_.push_back(PixelCoord{x + sx, y + sy});
+            }
+        }
+    }
+    inner_->PutPixels(points_.data(), points_.size(), color, blend);
+    stale_ = true;
+}
+
+void SupersampledRenderer::PutPixels(const PixelCoord* coords, const Color32* colors,
+                                     size_t count, BlendMode blend) {
+    points_.clear();
+    point_colors_.clear();
+    const size_t samples = static_cast<size_t>(factor_) * static_cast<size_t>(factor_);
+    for (size_t i = 0; i < count; ++i) {
+        const int x = ToSamples(coords[i].x, factor_);
+        const int y = ToSamples(coords[i].y, factor_);
+        for (int sy = 0; sy < factor_; ++sy) {
+            for (int sx = 0; sx < factor_; ++sx) {
+                points_.push_back(PixelCoord{x + sx, y + sy});
+            }
+        }
+        point_colors_.insert(point_colors_.end(), samples, colors[i]);
+    }
+    inner_->PutPixels(points_.data(), point_colors_.data(), points_.size(), blend);
+    stale_ = true;
+}
+
+void SupersampledRenderer::PutSpan(int x, int y, const Color32* colors, size_t count,
+                                   BlendMode blend) {
+    span_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        span_.insert(span_.end(), static_cast<size_t>(factor_), colors[i]);
+    }
+    const int sx = ToSamples(x, factor_);
+    const int sy = ToSamples(y, factor_);
+    for (int row = 0; row < factor_; ++row) {
+        inner_->PutSpan(sx, sy + row, span_.data(), span_.size(), blend);
+    }
+    stale_ = true;
+}
+
+void SupersampledRenderer::FillSpan(int x, int y, int width, Color32 color, BlendMode blend) {
+    inner_->FillRect(ToSamples(x, factor_), ToSamples(y, factor_), ToSamples(width, factor_),
+                     factor_, color, blend);
+    stale_ = true;
+}
+
+void SupersampledRenderer::FillRect(int x, int y, int width, int height, Color32 color,
+                                    BlendMode blend) {
+    inner_->FillRect(ToSamples(x, factor_), ToSamples(y, factor_), ToSamples(width, factor_),
+                     ToSamples(height, factor_), color, blend);
+    stale_ = true;
+}
+
+void SupersampledRenderer::FillTriangle(const ScreenVertex& v0, const ScreenVertex& v1,
+                                        const ScreenVertex& v2, Color32 color, BlendMode blend) {
+    const float s = static_cast<float>(factor_);
+    auto scale = [s](const ScreenVertex& v) { return ScreenVertex{v.x * s, v.y * s, v.z}; };
+    inner_->FillTriangle(scale(v0), scale(v1), scale(v2), color, blend);
+    stale_ = true;
+}
+
+void SupersampledRenderer::FillCircle(float cx, float cy, float radius, Color32 color,
+                                      BlendMode blend) {
+    const float s = static_cast<float>(factor_);
+    inner_->FillCircle(cx * s, cy * s, radius * s, color, blend);
+    stale_ = true;
+}
+
+void SupersampledRenderer::FillEllipse(float cx, float cy, float rx, float ry, Color32 color,
+                                       BlendMode blend) {
+    const float s = static_cast<float>(factor_);
+    inner_->FillEllipse(cx * s, cy * s, rx * s, ry * s, color, blend);
+    stale_ = true;
+}
+
+void SupersampledRenderer::StrokeRing(float cx, float cy, float inner_radius, float outer_radius,
+                                      Color32 color, BlendMode blend) {
+    const float s = static_cast<float>(factor_);
+    inner_->StrokeRing(cx * s, cy * s, inner_radius * s, outer_radius * s, color, blend);
+    stale_ = true;
+}
+
+void SupersampledRenderer::DrawLine(const LineSegment& line, Color32 color, BlendMode blend,
+                                    LineMode mode) {
+    DrawLines(&line, 1, color, blend, mode);
+}
+
+void SupersampledRenderer::DrawLines(const LineSegment* lines, size_t count, Color32 color,
+                                     BlendMode blend, LineMode mode) {
+    // factor parallel one-sample lines, stacked across the minor axis, make up one pixel of
+    // weight. The resolve already supplies the coverage antialiased lines would compute, so
+    // those become aliased lines composited the way the antialiased path would.
+    const float s = static_cast<float>(factor_);
+    lines_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const LineSegment& line = lines[i];
+        const LineSegment scaled{line.x0 * s, line.y0 * s, line.x1 * s, line.y1 * s};
+        const bool x_major = std::abs(scaled.x1 - scaled.x0) >= std::abs(scaled.y1 - scaled.y0);
+        for (int k = 0; k < factor_; ++k) {
+            const float offset = static_cast<float>(k) - 0.5f * (s - 1.0f);
+            LineSegment copy = scaled;
+            if (x_major) {
+                copy.y0 += offset;
+                copy.y1 += offset;
+            } else {
+                copy.x0 += offset;
+                copy.x1 += offset;
+            }
+            lines_.push_back(copy);
+        }
+    }
+    if (mode == LineMode::Antialiased && blend == BlendMode::Replace) {
+        blend = BlendMode::SourceOver;
+    }
+    inner_->DrawLines(lines_.data(), lines_.size(), color, blend, LineMode::Aliased);
+    stale_ = true;
+}
+
+void SupersampledRenderer::BlitTransformed(const Image& image, const ImageTransform& transform,
+                                           ImageFilter filter, BlendMode blend) {
+    const float s = static_cast<float>(factor_);
+    const ImageTransform scaled{transform.xx * s, transform.xy * s, transform.tx * s,
+                                transform.yx * s, transform.yy * s, transform.ty * s};
+    inner_->BlitTransformed(image, scaled, filter, blend);
+    stale_ = true;
+}
+
+const uint8_t* SupersampledRenderer::Pixels() const {
+    if (stale_ || !unresolved_.Rects().empty()) {
+        const Color32* samples = reinterpret_cast<const Color32*>(inner_->Pixels());
+        for (const PixelRect& rect : inner_->Damage()) {
+            ResolveRect(samples, rect);
+        }
+        for (const PixelRect& rect : unresolved_.Rects()) {
+            ResolveRect(samples, rect);
+        }
+        unresolved_.Reset();
+        stale_ = false;
+    }
+    return reinterpret_cast<const uint8_t*>(pixels_.data());
+}
+
+void SupersampledRenderer::ResolveRect(const Color32* samples, const PixelRect& rect) const {
+    const int x0 = std::max(0, DivideDown(rect.x, factor_));
+    const int y0 = std::max(0, DivideDown(rect.y, factor_));
+    const int x1 = std::min(width_, DivideUp(rect.x + rect.width, factor_));
+    const int y1 = std::min(height_, DivideUp(rect.y + rect.height, factor_));
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    const size_t source_pitch = static_cast<size_t>(inner_->Pitch());
+    const size_t block_rows = source_pitch * static_cast<size_t>(factor_);
+    for (int y = y0; y < y1; ++y) {
+        const Color32* row = samples + static_cast<size_t>(y) * block_rows +
+                             static_cast<size_t>(x0) * static_cast<size_t>(factor_);
+        Color32* dst = pixels_.data() + static_cast<size_t>(y) * static_cast<size_t>(pitch_) + x0;
+        ResolveBox(row, source_pitch, factor_, dst, static_cast<size_t>(x1 - x0));
+    }
+}
+
+const std::vector<PixelRect>& SupersampledRenderer::Damage() const {
+    damage_.clear();
+    for (const PixelRect& rect : inner_->Damage()) {
+        const int x0 = DivideDown(rect.x, factor_);
+        const int y0 = DivideDown(rect.y, factor_);
+        const int x1 = DivideUp(rect.x + rect.width, factor_);
+        const int y1 = DivideUp(rect.y + rect.height, factor_);
+        damage_.push_back(PixelRect{x0, y0, x1 - x0, y1 - y0});
+    }
+    return damage_;
+}
+
+void SupersampledRenderer::ResetDamage() {
+    // Damage nobody resolved yet would otherwise be forgotten with the inner renderer's.
+    if (stale_) {
+        for (const PixelRect& rect : inner_->Damage()) {
+            unresolved_.MarkDrawn(rect.x, rect.y, rect.x + rect.width, rect.y + rect.height);
+        }
+    }
+    inner_->ResetDamage();
+}
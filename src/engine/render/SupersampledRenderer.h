@@ -0,0 +1,91 @@
+#pragma once
+
+#include "engine/core/IRenderer.h"
+#include "engine/render/DamageTracker.h"
+#include "engine/render/FramebufferAllocator.h"
+
+#include <memory>
+#include <vector>
+
+// Ordered-grid supersampling around another renderer. The inner renderer draws at factor times
+// the width and height with every coordinate scaled to match, and Pixels() box-filters each
+// factor x factor block of samples down to one pixel, so edges of triangles, shapes, lines and
+// scaled blits come out antialiased. Cost grows with factor squared.
+//
+// Points and spans address whole pixels, so they cover whole blocks and resolve exactly as
+// drawn. Lines are widened to factor samples so they keep their one-pixel weight.
+class SupersampledRenderer : public IRenderer {
+  public:
+    // factor is the samples per pixel along each axis, at least 1.
+    SupersampledRenderer(std::unique_ptr<IRenderer> inner, int factor);
+
+    IRenderer& Inner() const { return *inner_; }
+    int Factor() const { return factor_; }
+
+    void Resize(int width, int height) override;
+    void Clear(Color32 color) override;
+    void PutPixel(int x, int y, Color32 color, BlendMode blend = BlendMode::Replace) override;
+    void PutPixels(const PixelCoord* coords, size_t count, Color32 color,
+                   BlendMode blend = BlendMode::Replace) override;
+    void PutPixels(const PixelCoord* coords, const Color32* colors, size_t count,
+                   BlendMode blend = BlendMode::Replace) override;
+    void PutSpan(int x, int y, const Color32* colors, size_t count,
+                 BlendMode blend = BlendMode::Replace) override;
+    void FillSpan(int x, int y, int width, Color32 color,
+                  BlendMode blend = BlendMode::Replace) override;
+    void FillRect(int x, int y, int width, int height, Color32 color,
+                  BlendMode blend = BlendMode::Replace) override;
+    void FillTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2,
+                      Color32 color, BlendMode blend = BlendMode::Replace) override;
+    void FillCircle(float cx, float cy, float radius, Color32 color,
+                    BlendMode blend = BlendMode::Replace) override;
+    void FillEllipse(float cx, float cy, float rx, float ry, Color32 color,
+                     BlendMode blend = BlendMode::Replace) override;
+    void StrokeRing(float cx, float cy, float inner_radius, float outer_radius, Color32 color,
+                    BlendMode blend = BlendMode::Replace) override;
+    void DrawLine(const LineSegment& line, Color32 color, BlendMode blend = BlendMode::Replace,
+                  LineMode mode = LineMode::Aliased) override;
+    void DrawLines(const LineSegment* lines, size_t count, Color32 color,
+                   BlendMode blend = BlendMode::Replace,
+                   LineMode mode = LineMode::Aliased) override;
+    void BlitTransformed(const Image& image, const ImageTransform& transform,
+                         ImageFilter filter = ImageFilter::Bilinear,
+                         BlendMode blend = BlendMode::Replace) override;
+
+    void SetDepthFormat(DepthFormat format) override { inner_->SetDepthFormat(format); }
+    DepthFormat GetDepthFormat() const override { return inner_->GetDepthFormat(); }
+    void ClearDepth(float depth = 1.0f) override { inner_->ClearDepth(depth); }
+
+    int Width() const override { return width_; }
+    int Height() const override { return height_; }
+    int Pitch() const override { return pitch_; }
+    // Resolves the blocks drawn since the previous call.
+    const uint8_t* Pixels() const override;
+    // The inner renderer's damage, scaled down to whole pixels.
+    const std::vector<PixelRect>& Damage() const override;
+    void ResetDamage() override;
+    // The inner renderer's counts, in samples rather than pixels.
+    const RenderStats& Stats() const override { return inner_->Stats(); }
+    void ResetStats() override { inner_->ResetStats(); }
+
+  private:
+    // Resolves the pixels covering a sample-space rect of samples.
+    void ResolveRect(const Color32* samples, const PixelRect& rect) const;
+
+    std::unique_ptr<IRenderer> inner_;
+    int factor_ = 1;
+    int width_ = 0;
+    int height_ = 0;
+    int pitch_ = 0;
+    // Resolved image, pitch_ pixels per row.
+    mutable FramebufferVector<Color32> pixels_;
+    mutable std::vector<PixelRect> damage_;
+    // Sample-space regions whose damage was reset before Pixels() resolved them.
+    mutable DamageTracker unresolved_;
+    // Set by every draw; cleared once Pixels() has resolved them.
+    mutable bool stale_ = true;
+    std::vector<PixelCoord> points_;
+    std::vector<Color32> point_colors_;
+    std::vector<Color32> span_;
+    std::vector<LineSegment> lines_;
+};
@@ -0,0 +1,261 @@
+#include "engine/render/TriangleRaster.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SANDBOX_RASTER_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+constexpr int kSubpixelBits = 4;
+constexpr int64_t kSubpixelOne = int64_t{1} << kSubpixelBits;
+constexpr int kBlockSize = 8;
+constexpr float kGuardBand = 16384.0f;
+
+// Edge function E(X, Y) = a * X + b * Y + c over subpixel coordinates. It is positive on the
+// inside; the fill rule bias is folded into c, so E >= 0 means covered.
+struct Edge {
+    int64_t a = 0;
+    int64_t b = 0;
+    int64_t c = 0;
+};
+
+Edge MakeEdge(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+    Edge edge;
+    edge.a = ay - by;
+    edge.b = bx - ax;
+    edge.c = -(edge.a * ax + edge.b * ay);
+    // Samples exactly on an edge belong to this triangle only for left edges and flat top
+    // edges; the neighbour sharing any other edge takes them instead.
+    const bool top_left = edge.a > 0 || (edge.a == 0 && edge.b > 0);
+    if (!top_left) {
+        edge.c -= 1;
+    }
+    return edge;
+}
+
+int64_t Snap(float v) { return static_cast<int64_t>(std::floor(v * kSubpixelOne + 0.5f)); }
+
+// Covered pixels of a row are contiguous because triangles are convex, so a non-zero row mask
+// reduces to its lowest and highest set bit.
+int FirstBit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long bit = 0;
+    _BitScanForward(&bit, mask);
+    return static_cast<int>(bit);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+int EndBit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long bit = 0;
+    _BitScanReverse(&bit, mask);
+    return static_cast<int>(bit) + 1;
+#else
+    return 32 - __builtin_clz(mask);
+#endif
+}
+
+// Per-pixel coverage for one block crossing at least one edge. e holds each edge at the
+// block's first sample; only edges that cross the block are passed, so every value stays
+// within a few block widths of zero and fits 32-bit lanes. rows[j] gets bit i set when pixel
+// (i, j) is covered.
+void CoverBlock(const int32_t* e, const int32_t* step_x, const int32_t* step_y, int edge_count,
+                unsigned* rows) {
+#if defined(SANDBOX_RASTER_SSE2)
+    __m128i lo[3];
+    __m128i hi[3];
+    __m128i dy[3];
+    for (int k = 0; k < edge_count; ++k) {
+        const int32_t sx = step_x[k];
+        lo[k] = _mm_add_epi32(_mm_set1_epi32(e[k]), _mm_set_epi32(3 * sx, 2 * sx, sx, 0));
+        hi[k] = _mm_add_epi32(lo[k], _mm_set1_epi32(4 * sx));
+        dy[k] = _mm_set1_epi32(step_y[k]);
+    }
+    for (int j = 0; j < kBlockSize; ++j) {
+        // OR-ing the edge values leaves the sign bit set wherever any edge is negative.
+        __m128i out_lo = _mm_setzero_si128();
+        __m128i out_hi = _mm_setzero_si128();
+        for (int k = 0; k < edge_count; ++k) {
+            out_lo = _mm_or_si128(out_lo, lo[k]);
+            out_hi = _mm_or_si128(out_hi, hi[k]);
+            lo[k] = _mm_add_epi32(lo[k], dy[k]);
+            hi[k] = _mm_add_epi32(hi[k], dy[k]);
+        }
+        const int outside = _mm_movemask_ps(_mm_castsi128_ps(out_lo)) |
+                            (_mm_movemask_ps(_mm_castsi128_ps(out_hi)) << 4);
+        rows[j] = ~static_cast<unsigned>(outside) & 0xFFu;
+    }
+#else
+    for (int j = 0; j < kBlockSize; ++j) {
+        unsigned mask = 0;
+        for (int i = 0; i < kBlockSize; ++i) {
+            bool inside = true;
+            for (int k = 0; k < edge_count; ++k) {
+                inside = inside && e[k] + step_x[k] * i + step_y[k] * j >= 0;
+            }
+            mask |= inside ? 1u << i : 0u;
+        }
+        rows[j] = mask;
+    }
+#endif
+}
+} // namespace
+
+bool TriangleBounds(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2,
+                    const RasterClip& clip, RasterClip* out) {
+    const float min_x = std::min({v0.x, v1.x, v2.x});
+    const float min_y = std::min({v0.y, v1.y, v2.y});
+    const float max_x = std::max({v0.x, v1.x, v2.x});
+    const float max_y = std::max({v0.y, v1.y, v2.y});
+    // Written so NaN coordinates fail too.
+    if (!(min_x < static_cast<float>(clip.x1) && min_y < static_cast<float>(clip.y1) &&
+          max_x >= static_cast<float>(clip.x0) && max_y >= static_cast<float>(clip.y0))) {
+        return false;
+    }
+    out->x0 = std::max(clip.x0, static_cast<int>(std::floor(min_x)));
+    out->y0 = std::max(clip.y0, static_cast<int>(std::floor(min_y)));
+    out->x1 = static_cast<int>(std::min(static_cast<float>(clip.x1), std::floor(max_x) + 1.0f));
+    out->y1 = static_cast<int>(std::min(static_cast<float>(clip.y1), std::floor(max_y) + 1.0f));
+    return out->x0 < out->x1 && out->y0 < out->y1;
+}
+
+void RasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2,
+                       const RasterClip& clip, std::vector<CoverageSpan>& spans) {
+    for (const ScreenVertex* v : {&v0, &v1, &v2}) {
+        // The negated compare also rejects NaN.
+        if (!(std::fabs(v->x) <= kGuardBand && std::fabs(v->y) <= kGuardBand)) {
+            return;
+        }
+    }
+    int64_t x[3] = {Snap(v0.x), Snap(v1.x), Snap(v2.x)};
+    int64_t y[3] = {Snap(v0.y), Snap(v1.y), Snap(v2.y)};
+    const int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area == 0) {
+        return;
+    }
+    if (area < 0) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+    }
+    const Edge edges[3] = {
+        MakeEdge(x[1], y[1], x[2], y[2]),
+        MakeEdge(x[2], y[2], x[0], y[0]),
+        MakeEdge(x[0], y[0], x[1], y[1]),
+    };
+
+    // Conservative pixel bounds, clipped.
+    const int64_t min_x = std::min({x[0], x[1], x[2]});
+    const int64_t max_x = std::max({x[0], x[1], x[2]});
+    const int64_t min_y = std::min({y[0], y[1], y[2]});
+    const int64_t max_y = std::max({y[0], y[1], y[2]});
+    const int px0 = std::max(clip.x0, static_cast<int>(min_x >> kSubpixelBits));
+    const int py0 = std::max(clip.y0, static_cast<int>(min_y >> kSubpixelBits));
+    const int px1 = std::min(clip.x1, static_cast<int>(max_x >> kSubpixelBits) + 1);
+    const int py1 = std::min(clip.y1, static_cast<int>(max_y >> kSubpixelBits) + 1);
+    if (px0 >= px1 || py0 >= py1) {
+        return;
+    }
+
+    // Per-pixel steps, and the offsets from a block's first sample to the corners where each
+    // edge is smallest and largest.
+    int64_t step_x[3];
+    int64_t step_y[3];
+    int64_t corner_min[3];
+    int64_t corner_max[3];
+    for (int k = 0; k < 3; ++k) {
+        step_x[k] = edges[k].a * kSubpixelOne;
+        step_y[k] = edges[k].b * kSubpixelOne;
+        const int64_t span_x = step_x[k] * (kBlockSize - 1);
+        const int64_t span_y = step_y[k] * (kBlockSize - 1);
+        corner_min[k] = std::min<int64_t>(span_x, 0) + std::min<int64_t>(span_y, 0);
+        corner_max[k] = std::max<int64_t>(span_x, 0) + std::max<int64_t>(span_y, 0);
+    }
+
+    // Blocks sit on the 8-pixel grid so they line up with tiles in the callers.
+    const int bx0 = px0 & ~(kBlockSize - 1);
+    const int by0 = py0 & ~(kBlockSize - 1);
+    const int64_t half = kSubpixelOne / 2;
+    for (int by = by0; by < py1; by += kBlockSize) {
+        int row_x0[kBlockSize];
+        int row_x1[kBlockSize];
+        std::fill(row_x0, row_x0 + kBlockSize, INT_MAX);
+        std::fill(row_x1, row_x1 + kBlockSize, INT_MIN);
+
+        int64_t e[3];
+        for (int k = 0; k < 3; ++k) {
+            e[k] = edges[k].a * (bx0 * kSubpixelOne + half) +
+                   edges[k].b * (by * kSubpixelOne + half) + edges[k].c;
+        }
+        bool entered = false;
+        for (int bx = bx0; bx < px1; bx += kBlockSize) {
+            bool reject = false;
+            int32_t partial_e[3];
+            int32_t partial_x[3];
+            int32_t partial_y[3];
+            int partial = 0;
+            for (int k = 0; k < 3; ++k) {
+                if (e[k] + corner_max[k] < 0) {
+                    reject = true;
+                    break;
+                }
+                if (e[k] + corner_min[k] < 0) {
+                    partial_e[partial] = static_cast<int32_t>(e[k]);
+                    partial_x[partial] = static_cast<int32_t>(step_x[k]);
+                    partial_y[partial] = static_cast<int32_t>(step_y[k]);
+                    ++partial;
+                }
+            }
+            for (int k = 0; k < 3; ++k) {
+                e[k] += step_x[k] * kBlockSize;
+            }
+            if (reject) {
+                // Each edge keeps an interval of blocks per band, so once coverage has been
+                // left behind the rest of the band is empty.
+                if (entered) {
+                    break;
+                }
+                continue;
+            }
+            entered = true;
+            if (partial == 0) {
+                for (int j = 0; j < kBlockSize; ++j) {
+                    row_x0[j] = std::min(row_x0[j], bx);
+                    row_x1[j] = std::max(row_x1[j], bx + kBlockSize);
+                }
+                continue;
+            }
+            unsigned rows[kBlockSize];
+            CoverBlock(partial_e, partial_x, partial_y, partial, rows);
+            for (int j = 0; j < kBlockSize; ++j) {
+                if (rows[j]) {
+                    row_x0[j] = std::min(row_x0[j], bx + FirstBit(rows[j]));
+                    row_x1[j] = std::max(row_x1[j], bx + EndBit(rows[j]));
+                }
+            }
+        }
+
+        for (int j = 0; j < kBlockSize; ++j) {
+            const int row = by + j;
+            const int sx0 = std::max(row_x0[j], px0);
+            const int sx1 = std::min(row_x1[j], px1);
+            if (row < py0 || row >= py1 || sx0 >= sx1) {
+                continue;
+            }
+            CoverageSpan span;
+            span.y = row;
+            span.x = sx0;
+            span.count = sx1 - sx0;
+            spans.push_back(span);
+        }
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "engine/core/ScreenVertex.h"
+#include "engine/render/RasterCoverage.h"
+
+#include <vector>
+
+// Half-space rasterizer. Vertices are snapped to 1/16 pixel and edge functions are walked over
+// 8x8 blocks: blocks outside an edge are skipped, blocks inside all three are taken whole, and
+// only blocks crossing an edge are tested per pixel (four pixels per SSE2 op). Shared edges
+// follow the top-left rule, so adjacent triangles neither overlap nor leave gaps. Either
+// winding is accepted.
+//
+// Covered runs are appended to spans in increasing y, at most one per row. Triangles with a
+// vertex beyond +/-16384 pixels are dropped; callers clip larger geometry first.
+// Pixel bounds of the triangle, clipped; false when nothing inside clip can be covered.
+bool TriangleBounds(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2,
+                    const RasterClip& clip, RasterClip* out);
+
+void RasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2,
+                       const RasterClip& clip, std::vector<CoverageSpan>& spans);
@@ -2,12 +2,32 @@
 
 #ifdef _WIN32
 #include <GLFW/glfw3native.h>
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <dxgi.h>
 #include <iterator>
 
 namespace {
 DXGI_FORMAT kBackbufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+// B5G6R5 keeps red in the top bits of each 16-bit word, matching PixelFormat::RGB565.
+DXGI_FORMAT ToDxgi(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::BGRA8:
+        return DXGI_FORMAT_B8G8R8A8_UNORM;
+    case PixelFormat::RGB565:
+        return DXGI_FORMAT_B5G6R5_UNORM;
+    case PixelFormat::Palette8:
+        return DXGI_FORMAT_UNKNOWN;
+    default:
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+} // namespace
+
+bool D3d11Presenter::SupportsFormat(PixelFormat format) {
+    return ToDxgi(format) != DXGI_FORMAT_UNKNOWN;
 }
 
 bool D3d11Presenter::Init(GLFWwindow* window) {
@@ -94,7 +114,7 @@ bool D3d11Presenter::CreateTexture(int width, int height) {
     desc.Height = static_cast<UINT>(height);
     desc.MipLevels = 1;
     desc.ArraySize = 1;
-    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.Format = ToDxgi(format_);
     desc.SampleDesc.Count = 1;
     desc.Usage = D3D11_USAGE_DYNAMIC;
     desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
@@ -124,6 +144,14 @@ bool D3d11Presenter::CreateTexture(int width, int height) {
     return true;
 }
 
+float D3d11Presenter::UvExtentX() const {
+    return tex_width_ > 0 ? static_cast<float>(visible_width_) / tex_width_ : 1.0f;
+}
+
+float D3d11Presenter::UvExtentY() const {
+    return tex_height_ > 0 ? static_cast<float>(visible_height_) / tex_height_ : 1.0f;
+}
+
 bool D3d11Presenter::Upload(const IRenderer& renderer) {
     if (!initialized_) {
         return false;
@@ -134,27 +162,54 @@ bool D3d11Presenter::Upload(const IRenderer& renderer) {
         return false;
     }
 
-    if (!texture_ || width != tex_width_ || height != tex_height_) {
-        if (!CreateTexture(width, height)) {
+    // The texture only grows; smaller frames occupy its top-left corner, addressed by UVs.
+    if (!SupportsFormat(renderer.Format())) {
+        return false;
+    }
+    bool created = false;
+    if (renderer.Format() != format_) {
+        format_ = renderer.Format();
+        texture_.Reset();
+    }
+    if (!texture_ || width > tex_width_ || height > tex_height_) {
+        if (!CreateTexture(std::max(width, tex_width_), std::max(height, tex_height_))) {
             return false;
         }
+        created = true;
+    }
+    visible_width_ = width;
+    visible_height_ = height;
+
+    // WRITE_DISCARD hands back undefined contents, so any damage means a full copy; a frame
+    // without damage leaves the texture untouched.
+    const uint8_t* src = renderer.Pixels();
+    if (!created && renderer.Damage().empty()) {
+        upload_bytes_ = 0;
+        return true;
     }
 
+    const auto start = std::chrono::steady_clock::now();
     D3D11_MAPPED_SUBRESOURCE mapped = {};
     HRESULT hr = context_->Map(texture_.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
     if (FAILED(hr)) {
         return false;
     }
 
-    const uint8_t* src = renderer.Pixels();
-    const size_t row_bytes = static_cast<size_t>(width) * 4;
+    const size_t bytes_per_pixel = BytesPerPixel(format_);
+    const size_t row_bytes = static_cast<size_t>(width) * bytes_per_pixel;
+    const size_t src_pitch = static_cast<size_t>(renderer.Pitch()) * bytes_per_pixel;
     uint8_t* dst = static_cast<uint8_t*>(mapped.pData);
     for (int y = 0; y < height; ++y) {
         std::memcpy(dst + static_cast<size_t>(y) * mapped.RowPitch,
-                    src + static_cast<size_t>(y) * row_bytes, row_bytes);
+                    src + static_cast<size_t>(y) * src_pitch, row_bytes);
     }
 
     context_->Unmap(texture_.Get(), 0);
+
+    const std::chrono::duration<float, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    upload_ms_ += (elapsed.count() - upload_ms_) * 0.1f;
+    upload_bytes_ = row_bytes * height;
     return true;
 }
 
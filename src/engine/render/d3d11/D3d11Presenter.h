@@ -2,6 +2,7 @@
 
 #include "engine/core/IRenderer.h"
 
+#include <cstddef>
 #include <cstdint>
 
 #ifdef _WIN32
@@ -16,10 +17,18 @@ class D3d11Presenter {
     void Shutdown();
     void Resize(int width, int height);
     bool Upload(const IRenderer& renderer);
+    // Formats the texture can hold as-is; there is no shader pass to expand Palette8.
+    static bool SupportsFormat(PixelFormat format);
     void BeginFrame(const float clear_color[4]);
     void EndFrame();
     void Present(bool vsync);
     void* TextureId() const { return texture_srv_.Get(); }
+    // Fraction of the texture the last uploaded frame covers.
+    float UvExtentX() const;
+    float UvExtentY() const;
+    // CPU time spent copying into the texture (smoothed) and the bytes copied by the last upload.
+    float UploadMs() const { return upload_ms_; }
+    size_t UploadBytes() const { return upload_bytes_; }
 
     ID3D11Device* Device() const { return device_.Get(); }
     ID3D11DeviceContext* Context() const { return context_.Get(); }
@@ -38,7 +47,12 @@ class D3d11Presenter {
     Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> texture_srv_;
     int tex_width_ = 0;
     int tex_height_ = 0;
+    PixelFormat format_ = PixelFormat::RGBA8;
+    int visible_width_ = 0;
+    int visible_height_ = 0;
     int backbuffer_width_ = 0;
     int backbuffer_height_ = 0;
+    float upload_ms_ = 0.0f;
+    size_t upload_bytes_ = 0;
     bool initialized_ = false;
 };
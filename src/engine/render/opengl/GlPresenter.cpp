@@ -1,5 +1,10 @@
 #include "engine/render/opengl/GlPresenter.h"
 
+#include "engine/render/PixelPacking.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 
 #if defined(__APPLE__)
@@ -9,6 +14,32 @@
 #endif
 
 namespace {
+// Upper bound on each client wait for a fence; waits repeat until the fence signals.
+constexpr uint64_t kFenceWaitNs = 1000000;
+
+bool HasBufferStorage() {
+#if defined(__APPLE__)
+    return false;
+#else
+    int major = 0;
+    int minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major > 4 || (major == 4 && minor >= 4)) {
+        return true;
+    }
+    int extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (int i = 0; i < extensions; ++i) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_ARB_buffer_storage") == 0) {
+            return true;
+        }
+    }
+    return false;
+#endif
+}
+
 unsigned int CompileShader(unsigned int type, const char* source) {
     unsigned int shader = glCreateShader(type);
     glShaderSource(shader, 1, &source, nullptr);
@@ -24,24 +55,56 @@ unsigned int CompileShader(unsigned int type, const char* source) {
     return shader;
 }
 
-unsigned int CreateProgram() {
+const char* kFragmentSource = "#version 330 core\n"
+                              "in vec2 v_uv;\n"
+                              "out vec4 frag_color;\n"
+                              "uniform sampler2D u_tex;\n"
+                              "void main() {\n"
+                              "  frag_color = texture(u_tex, v_uv);\n"
+                              "}\n";
+
+// Expands a Palette8 index texture texel for texel; drawn over the visible region of the
+// index texture, so fragment coordinates address it directly.
+const char* kPaletteFragmentSource =
+    "#version 330 core\n"
+    "out vec4 frag_color;\n"
+    "uniform sampler2D u_tex;\n"
+    "uniform sampler2D u_palette;\n"
+    "void main() {\n"
+    "  float index = texelFetch(u_tex, ivec2(gl_FragCoord.xy), 0).r;\n"
+    "  frag_color = texelFetch(u_palette, ivec2(int(index * 255.0 + 0.5), 0), 0);\n"
+    "}\n";
+
+struct GlFormat {
+    int internal_format;
+    unsigned int format;
+    unsigned int type;
+};
+
+GlFormat ToGl(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::BGRA8:
+        return {GL_RGBA, GL_BGRA, GL_UNSIGNED_BYTE};
+    case PixelFormat::RGB565:
+        return {GL_RGB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5};
+    case PixelFormat::Palette8:
+        return {GL_R8, GL_RED, GL_UNSIGNED_BYTE};
+    default:
+        return {GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE};
+    }
+}
+
+unsigned int CreateProgram(const char* fragment_source) {
     const char* vertex_source = "#version 330 core\n"
                                 "in vec2 a_pos;\n"
                                 "in vec2 a_uv;\n"
                                 "out vec2 v_uv;\n"
+                                "uniform vec2 u_uv_extent;\n"
                                 "void main() {\n"
-                                "  v_uv = a_uv;\n"
+                                "  v_uv = a_uv * u_uv_extent;\n"
                                 "  gl_Position = vec4(a_pos, 0.0, 1.0);\n"
                                 "}\n";
 
-    const char* fragment_source = "#version 330 core\n"
-                                  "in vec2 v_uv;\n"
-                                  "out vec4 frag_color;\n"
-                                  "uniform sampler2D u_tex;\n"
-                                  "void main() {\n"
-                                  "  frag_color = texture(u_tex, v_uv);\n"
-                                  "}\n";
-
     unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertex_source);
     unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragment_source);
 
@@ -71,7 +134,7 @@ bool GlPresenter::Init() {
         return true;
     }
 
-    program_ = CreateProgram();
+    program_ = CreateProgram(kFragmentSource);
     if (!program_) {
         return false;
     }
@@ -110,9 +173,13 @@ bool GlPresenter::Init() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glBindTexture(GL_TEXTURE_2D, 0);
 
+    glGenBuffers(kUploadBuffers, upload_buffers_);
+    buffer_storage_ = HasBufferStorage();
+
     glUseProgram(program_);
     int sampler = glGetUniformLocation(program_, "u_tex");
     glUniform1i(sampler, 0);
+    uv_extent_location_ = glGetUniformLocation(program_, "u_uv_extent");
     glUseProgram(0);
 
     glDisable(GL_DEPTH_TEST);
@@ -126,9 +193,14 @@ void GlPresenter::Shutdown() {
     if (!initialized_) {
         return;
     }
+    ReleaseMappedTarget();
+    ReleasePalette();
     if (texture_) {
         glDeleteTextures(1, &texture_);
     }
+    if (upload_buffers_[0]) {
+        glDeleteBuffers(kUploadBuffers, upload_buffers_);
+    }
     if (ebo_) {
         glDeleteBuffers(1, &ebo_);
     }
@@ -143,6 +215,10 @@ void GlPresenter::Shutdown() {
     }
 
     texture_ = 0;
+    for (unsigned int& buffer : upload_buffers_) {
+        buffer = 0;
+    }
+    upload_index_ = 0;
     ebo_ = 0;
     vbo_ = 0;
     vao_ = 0;
@@ -158,16 +234,117 @@ void GlPresenter::Resize(int width, int height) {
         return;
     }
 
-    if (width != tex_width_ || height != tex_height_) {
-        tex_width_ = width;
-        tex_height_ = height;
-        glBindTexture(GL_TEXTURE_2D, texture_);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex_width_, tex_height_, 0, GL_RGBA,
-                     GL_UNSIGNED_BYTE, nullptr);
+    // The texture only grows, so shrinking and growing back within its size never reallocates;
+    // the frame occupies its top-left corner and is addressed through UvExtentX/Y.
+    if (width > tex_width_ || height > tex_height_) {
+        tex_width_ = std::max(width, tex_width_);
+        tex_height_ = std::max(height, tex_height_);
+        AllocateTexture();
+    }
+    visible_width_ = width;
+    visible_height_ = height;
+
+    glViewport(0, 0, visible_width_, visible_height_);
+}
+
+void GlPresenter::AllocateTexture() {
+    const GlFormat gl = ToGl(format_);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, gl.internal_format, tex_width_, tex_height_, 0, gl.format,
+                 gl.type, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    full_upload_ = true;
+    if (format_ == PixelFormat::Palette8) {
+        AllocatePalette();
+    }
+}
+
+void GlPresenter::AllocatePalette() {
+    if (!palette_program_) {
+        palette_program_ = CreateProgram(kPaletteFragmentSource);
+        glUseProgram(palette_program_);
+        glUniform1i(glGetUniformLocation(palette_program_, "u_tex"), 0);
+        glUniform1i(glGetUniformLocation(palette_program_, "u_palette"), 1);
+        glUseProgram(0);
+
+        Color32 palette[256];
+        for (int i = 0; i < 256; ++i) {
+            palette[i] = PalettePixel(static_cast<uint8_t>(i));
+        }
+        glGenTextures(1, &palette_texture_);
+        glBindTexture(GL_TEXTURE_2D, palette_texture_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, palette);
+
+        glGenTextures(1, &display_texture_);
+        glBindTexture(GL_TEXTURE_2D, display_texture_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glBindTexture(GL_TEXTURE_2D, 0);
+        glGenFramebuffers(1, &palette_framebuffer_);
+    }
+
+    // The expanded image matches the index texture texel for texel, UV extent included.
+    glBindTexture(GL_TEXTURE_2D, display_texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex_width_, tex_height_, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, palette_framebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, display_texture_,
+                           0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void GlPresenter::ExpandPalette() {
+    int viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, palette_framebuffer_);
+    glViewport(0, 0, visible_width_, visible_height_);
+    glUseProgram(palette_program_);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, palette_texture_);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glBindVertexArray(vao_);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void GlPresenter::ReleasePalette() {
+    if (palette_framebuffer_) {
+        glDeleteFramebuffers(1, &palette_framebuffer_);
+    }
+    if (display_texture_) {
+        glDeleteTextures(1, &display_texture_);
     }
+    if (palette_texture_) {
+        glDeleteTextures(1, &palette_texture_);
+    }
+    if (palette_program_) {
+        glDeleteProgram(palette_program_);
+    }
+    palette_framebuffer_ = 0;
+    display_texture_ = 0;
+    palette_texture_ = 0;
+    palette_program_ = 0;
+}
 
-    glViewport(0, 0, tex_width_, tex_height_);
+float GlPresenter::UvExtentX() const {
+    return tex_width_ > 0 ? static_cast<float>(visible_width_) / tex_width_ : 1.0f;
+}
+
+float GlPresenter::UvExtentY() const {
+    return tex_height_ > 0 ? static_cast<float>(visible_height_) / tex_height_ : 1.0f;
 }
 
 bool GlPresenter::Upload(const IRenderer& renderer) {
@@ -179,18 +356,209 @@ bool GlPresenter::Upload(const IRenderer& renderer) {
         return false;
     }
 
-    if (renderer.Width() != tex_width_ || renderer.Height() != tex_height_) {
+    if (renderer.Format() != format_) {
+        format_ = renderer.Format();
+        if (tex_width_ > 0) {
+            AllocateTexture();
+        }
+    }
+    if (renderer.Width() != visible_width_ || renderer.Height() != visible_height_) {
         Resize(renderer.Width(), renderer.Height());
     }
 
+    const uint8_t* pixels = renderer.Pixels();
+    const std::vector<PixelRect>& damage = renderer.Damage();
+    if (!full_upload_ && damage.empty()) {
+        upload_bytes_ = 0;
+        return true;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const int pitch = renderer.Pitch();
+    if (full_upload_) {
+        upload_rects_.assign(1, PixelRect{0, 0, renderer.Width(), renderer.Height()});
+    } else {
+        upload_rects_.assign(damage.begin(), damage.end());
+    }
+    size_t bytes = 0;
+    for (const PixelRect& rect : upload_rects_) {
+        bytes += static_cast<size_t>(rect.width) * rect.height * BytesPerPixel(format_);
+    }
+
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, texture_);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, renderer.Width(), renderer.Height(), GL_RGBA,
-                    GL_UNSIGNED_BYTE, renderer.Pixels());
+    if (mapped_pixels_ && pixels == reinterpret_cast<const uint8_t*>(mapped_pixels_)) {
+        UploadMapped(pitch, upload_rects_);
+    } else if (!streamed_upload_ || !UploadStreamed(pixels, pitch, upload_rects_, bytes)) {
+        UploadClient(pixels, pitch, upload_rects_);
+    }
     glBindTexture(GL_TEXTURE_2D, 0);
+    full_upload_ = false;
+    if (format_ == PixelFormat::Palette8) {
+        ExpandPalette();
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    upload_ms_ += (elapsed.count() - upload_ms_) * 0.1f;
+    upload_bytes_ = bytes;
+    return true;
+}
+
+void GlPresenter::UploadClient(const uint8_t* pixels, int pitch,
+                               const std::vector<PixelRect>& rects) {
+    // Rows of a rect are strided by the renderer's pitch.
+    const GlFormat gl = ToGl(format_);
+    const size_t bytes_per_pixel = BytesPerPixel(format_);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch);
+    for (const PixelRect& rect : rects) {
+        const size_t offset = (static_cast<size_t>(rect.y) * pitch + rect.x) * bytes_per_pixel;
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, gl.format,
+                        gl.type, pixels + offset);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+bool GlPresenter::UploadStreamed(const uint8_t* pixels, int pitch,
+                                 const std::vector<PixelRect>& rects, size_t bytes) {
+    const unsigned int buffer = upload_buffers_[upload_index_];
+    if (!buffer) {
+        return false;
+    }
+    upload_index_ = (upload_index_ + 1) % kUploadBuffers;
+
+    // Orphaning hands back fresh storage, so the copy never waits for the GPU to finish reading
+    // what an earlier frame left in this buffer.
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_DRAW);
+    auto* dst = static_cast<uint8_t*>(
+        glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes),
+                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!dst) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // Rects are packed back to back so only damaged pixels cross into GL memory.
+    const size_t bytes_per_pixel = BytesPerPixel(format_);
+    const size_t src_pitch = static_cast<size_t>(pitch) * bytes_per_pixel;
+    size_t offset = 0;
+    for (const PixelRect& rect : rects) {
+        const size_t row_bytes = static_cast<size_t>(rect.width) * bytes_per_pixel;
+        const uint8_t* src = pixels + rect.y * src_pitch + rect.x * bytes_per_pixel;
+        for (int y = 0; y < rect.height; ++y) {
+            std::memcpy(dst + offset, src, row_bytes);
+            offset += row_bytes;
+            src += src_pitch;
+        }
+    }
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // With a buffer bound, the pointer argument is an offset into it and the copy is queued
+    // rather than performed before the call returns.
+    const GlFormat gl = ToGl(format_);
+    offset = 0;
+    for (const PixelRect& rect : rects) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, gl.format,
+                        gl.type, reinterpret_cast<const void*>(offset));
+        offset += static_cast<size_t>(rect.width) * rect.height * bytes_per_pixel;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     return true;
 }
 
+void GlPresenter::UploadMapped(int pitch, const std::vector<PixelRect>& rects) {
+    // The frame already sits in the buffer, so rects are sourced in place at the frame's stride.
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mapped_buffer_);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch);
+    for (const PixelRect& rect : rects) {
+        const size_t offset = (static_cast<size_t>(rect.y) * pitch + rect.x) * sizeof(Color32);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, GL_RGBA,
+                        GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset));
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // MappedTarget waits on this before handing the storage back for the next frame.
+    if (mapped_fence_) {
+        glDeleteSync(static_cast<GLsync>(mapped_fence_));
+    }
+    mapped_fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+Color32* GlPresenter::MappedTarget(int width, int height) {
+#if defined(__APPLE__)
+    (void)width;
+    (void)height;
+    return nullptr;
+#else
+    if (!initialized_ || !buffer_storage_ || width <= 0 || height <= 0) {
+        return nullptr;
+    }
+    // Like the texture, the buffer only grows.
+    const size_t bytes = static_cast<size_t>(width) * height * sizeof(Color32);
+    if (mapped_pixels_ && bytes <= mapped_bytes_) {
+        WaitForMappedTarget();
+        return mapped_pixels_;
+    }
+    ReleaseMappedTarget();
+
+    // Renderers blend against what they wrote, so the storage is requested readable and in
+    // client memory; write-combined memory would turn every read-back into an uncached load.
+    const GLbitfield access =
+        GL_MAP_WRITE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &mapped_buffer_);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mapped_buffer_);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr,
+                    access | GL_CLIENT_STORAGE_BIT);
+    void* mapped =
+        glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), access);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!mapped) {
+        std::cerr << "Persistent mapping failed; using copied uploads\n";
+        glDeleteBuffers(1, &mapped_buffer_);
+        mapped_buffer_ = 0;
+        buffer_storage_ = false;
+        return nullptr;
+    }
+
+    mapped_pixels_ = static_cast<Color32*>(mapped);
+    mapped_bytes_ = bytes;
+    return mapped_pixels_;
+#endif
+}
+
+void GlPresenter::WaitForMappedTarget() {
+    if (!mapped_fence_) {
+        return;
+    }
+    GLsync fence = static_cast<GLsync>(mapped_fence_);
+    // The first wait flushes so the fence is certain to be submitted and eventually signal.
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceWaitNs);
+    while (result == GL_TIMEOUT_EXPIRED) {
+        result = glClientWaitSync(fence, 0, kFenceWaitNs);
+    }
+    glDeleteSync(fence);
+    mapped_fence_ = nullptr;
+}
+
+void GlPresenter::ReleaseMappedTarget() {
+    WaitForMappedTarget();
+    if (!mapped_buffer_) {
+        return;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mapped_buffer_);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &mapped_buffer_);
+    mapped_buffer_ = 0;
+    mapped_pixels_ = nullptr;
+    mapped_bytes_ = 0;
+}
+
 void GlPresenter::DrawFullscreen() {
     if (!initialized_) {
         return;
@@ -200,7 +568,9 @@ void GlPresenter::DrawFullscreen() {
     glClear(GL_COLOR_BUFFER_BIT);
 
     glUseProgram(program_);
+    glUniform2f(uv_extent_location_, UvExtentX(), UvExtentY());
     glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, DisplayTexture());
     glBindVertexArray(vao_);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
     glBindVertexArray(0);
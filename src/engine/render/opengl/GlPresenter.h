@@ -2,26 +2,86 @@
 
 #include "engine/core/IRenderer.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <imgui.h>
+#include <vector>
 
 class GlPresenter {
   public:
     bool Init();
     void Shutdown();
     void Resize(int width, int height);
+    // Uploads the renderer's damage rects, or everything after the texture was reallocated.
+    // The caller resets the renderer's damage once this succeeds.
     bool Upload(const IRenderer& renderer);
     void DrawFullscreen();
     void Present(const IRenderer& renderer);
-    ImTextureID TextureId() const { return (ImTextureID)(intptr_t)texture_; }
+    ImTextureID TextureId() const { return (ImTextureID)(intptr_t)DisplayTexture(); }
+    // Fraction of the texture the last uploaded frame covers.
+    float UvExtentX() const;
+    float UvExtentY() const;
+    // Streams uploads through a ring of pixel unpack buffers so the texture copy runs
+    // asynchronously; when disabled, pixels are read from client memory during the call.
+    void SetStreamedUpload(bool enabled) { streamed_upload_ = enabled; }
+    bool StreamedUpload() const { return streamed_upload_; }
+    // Persistently mapped storage for a width x height frame that a renderer can draw into
+    // directly, so Upload copies from GPU-visible memory without a CPU pass. Waits until the GPU
+    // has finished reading the previous frame from it. Returns nullptr when the context lacks
+    // buffer storage (GL 4.4 or ARB_buffer_storage).
+    Color32* MappedTarget(int width, int height);
+    // CPU time spent in Upload (smoothed, excluding the renderer's own Pixels() work) and the
+    // bytes copied by the last upload.
+    float UploadMs() const { return upload_ms_; }
+    size_t UploadBytes() const { return upload_bytes_; }
 
   private:
+    static constexpr int kUploadBuffers = 3;
+
+    void UploadClient(const uint8_t* pixels, int pitch, const std::vector<PixelRect>& rects);
+    bool UploadStreamed(const uint8_t* pixels, int pitch, const std::vector<PixelRect>& rects,
+                        size_t bytes);
+    void UploadMapped(int pitch, const std::vector<PixelRect>& rects);
+    void WaitForMappedTarget();
+    void ReleaseMappedTarget();
+    void AllocateTexture();
+    void AllocatePalette();
+    void ExpandPalette();
+    void ReleasePalette();
+    // Palette8 frames are shown through their RGBA expansion rather than the index texture.
+    unsigned int DisplayTexture() const {
+        return format_ == PixelFormat::Palette8 ? display_texture_ : texture_;
+    }
+
     unsigned int program_ = 0;
     unsigned int vao_ = 0;
     unsigned int vbo_ = 0;
     unsigned int ebo_ = 0;
+    // Holds uploads in format_'s own layout; the GPU converts when sampling or expanding it.
     unsigned int texture_ = 0;
+    PixelFormat format_ = PixelFormat::RGBA8;
+    unsigned int palette_program_ = 0;
+    unsigned int palette_texture_ = 0;
+    unsigned int display_texture_ = 0;
+    unsigned int palette_framebuffer_ = 0;
+    unsigned int upload_buffers_[kUploadBuffers] = {};
+    int upload_index_ = 0;
+    bool buffer_storage_ = false;
+    unsigned int mapped_buffer_ = 0;
+    Color32* mapped_pixels_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    // GLsync of the last upload sourced from mapped_buffer_.
+    void* mapped_fence_ = nullptr;
     int tex_width_ = 0;
     int tex_height_ = 0;
+    int visible_width_ = 0;
+    int visible_height_ = 0;
+    int uv_extent_location_ = -1;
+    // The texture was (re)allocated and holds nothing yet, so the next upload ignores damage.
+    bool full_upload_ = true;
+    bool streamed_upload_ = true;
+    float upload_ms_ = 0.0f;
+    size_t upload_bytes_ = 0;
+    std::vector<PixelRect> upload_rects_;
     bool initialized_ = false;
 };
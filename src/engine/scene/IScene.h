@@ -12,6 +12,10 @@ class IScene {
     virtual void Reset() {}
     virtual void Update(const FrameContext& context) { (void)context; }
     virtual void Render(IRenderer& renderer) = 0;
+    // Whether the next Render could draw something different from the previous one onto the
+    // same target. The main loop skips the frame otherwise; scenes that do not track their
+    // state keep the default and are redrawn every frame.
+    virtual bool OutputChanged() const { return true; }
     virtual void DrawSceneGui() {}
     virtual void DrawInspectorGui() {}
 };
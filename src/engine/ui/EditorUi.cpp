@@ -4,6 +4,7 @@
 #include "engine/scene/SceneManager.h"
 
 #include <algorithm>
+#include <cfloat>
 #include <cstdint>
 #include <cstdio>
 #include <fstream>
@@ -11,8 +12,10 @@
 #include <imgui_internal.h>
 
 namespace {
-void DrawViewportImage(ImTextureID texture_id, int fb_width, int fb_height, ImVec2* out_pos,
-                       ImVec2* out_size) {
+// uv_extent is the part of the texture the frame occupies; presenters keep a texture at least as
+// large as any frame so far.
+void DrawViewportImage(ImTextureID texture_id, ImVec2 uv_extent, int fb_width, int fb_height,
+                       ImVec2* out_pos, ImVec2* out_size) {
     ImVec2 size = ImGui::GetContentRegionAvail();
     if (size.x <= 0.0f || size.y <= 0.0f) {
         return;
@@ -34,9 +37,9 @@ void DrawViewportImage(ImTextureID texture_id, int fb_width, int fb_height, ImVe
     ImGui::SetCursorPos(ImVec2(cursor.x + padding.x, cursor.y + padding.y));
     ImVec2 image_pos = ImGui::GetCursorScreenPos();
 #if defined(SANDBOX_D3D11)
-    ImGui::Image(texture_id, image_size, ImVec2(0, 0), ImVec2(1, 1));
+    ImGui::Image(texture_id, image_size, ImVec2(0, 0), uv_extent);
 #else
-    ImGui::Image(texture_id, image_size, ImVec2(0, 1), ImVec2(1, 0));
+    ImGui::Image(texture_id, image_size, ImVec2(0, uv_extent.y), ImVec2(uv_extent.x, 0));
 #endif
     if (out_pos) {
         *out_pos = image_pos;
@@ -46,6 +49,30 @@ void DrawViewportImage(ImTextureID texture_id, int fb_width, int fb_height, ImVe
     }
 }
 
+// Outlines the 5x5 block of framebuffer pixels around (px, py), counted from the top of the
+// image as shown, on top of the viewport image rather than in the frame itself.
+void DrawPixelCursor(ImVec2 image_pos, ImVec2 image_size, int fb_width, int fb_height, int px,
+                     int py) {
+    const float scale_x = image_size.x / static_cast<float>(fb_width);
+    const float scale_y = image_size.y / static_cast<float>(fb_height);
+    const ImVec2 min(image_pos.x + static_cast<float>(px - 2) * scale_x,
+                     image_pos.y + static_cast<float>(py - 2) * scale_y);
+    const ImVec2 max(min.x + 5.0f * scale_x, min.y + 5.0f * scale_y);
+    const ImU32 color = ImGui::IsMouseDown(ImGuiMouseButton_Left) ? IM_COL32(64, 200, 120, 255)
+                                                                  : IM_COL32(240, 120, 120, 255);
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    draw_list->PushClipRect(image_pos,
+                            ImVec2(image_pos.x + image_size.x, image_pos.y + image_size.y), true);
+    draw_list->AddRectFilled(min, max, color);
+    draw_list->PopClipRect();
+}
+
+// One counter of the Stats panel: the latest frame's value and the rolling average.
+void StatRow(const char* label, uint64_t last, double average) {
+    ImGui::Text("%-16s %12llu  avg %14.1f", label, static_cast<unsigned long long>(last),
+                average);
+}
+
 void BuildDefaultDockLayout(ImGuiID dockspace_id) {
     ImGuiViewport* viewport = ImGui::GetMainViewport();
     ImGui::DockBuilderRemoveNode(dockspace_id);
@@ -69,13 +96,14 @@ void BuildDefaultDockLayout(ImGuiID dockspace_id) {
     ImGui::DockBuilderDockWindow("Scene for Camera A", dock_main);
     ImGui::DockBuilderDockWindow("Log", dock_bottom);
     ImGui::DockBuilderDockWindow("Render Settings", dock_bottom_right);
+    ImGui::DockBuilderDockWindow("Stats", dock_bottom_right);
 
     ImGui::DockBuilderFinish(dockspace_id);
 }
 } // namespace
 
-void EditorUi::Draw(ImTextureID texture_id, int fb_width, int fb_height, int win_width,
-                    int win_height, SceneManager& scenes) {
+void EditorUi::Draw(ImTextureID texture_id, ImVec2 uv_extent, int fb_width, int fb_height,
+                    int win_width, int win_height, SceneManager& scenes) {
     const ImGuiDockNodeFlags dock_flags = ImGuiDockNodeFlags_PassthruCentralNode;
     viewport_has_mouse_ = false;
 
@@ -98,7 +126,7 @@ void EditorUi::Draw(ImTextureID texture_id, int fb_width, int fb_height, int win
 
         ImVec2 image_pos{};
         ImVec2 image_size{};
-        DrawViewportImage(texture_id, fb_width, fb_height, &image_pos, &image_size);
+        DrawViewportImage(texture_id, uv_extent, fb_width, fb_height, &image_pos, &image_size);
 
         if (show_fps_overlay_) {
             ImGuiIO& io = ImGui::GetIO();
@@ -138,6 +166,7 @@ void EditorUi::Draw(ImTextureID texture_id, int fb_width, int fb_height, int win
             viewport_has_mouse_ = true;
             viewport_mouse_x_ = px;
             viewport_mouse_y_ = fb_height - 1 - py;
+            DrawPixelCursor(image_pos, image_size, fb_width, fb_height, px, py);
         }
 
         ImGui::End();
@@ -211,6 +240,7 @@ void EditorUi::Draw(ImTextureID texture_id, int fb_width, int fb_height, int win
             ImGui::MenuItem("Viewport", nullptr, &show_viewport_);
             ImGui::MenuItem("Log", nullptr, &show_log_);
             ImGui::MenuItem("Viewport Config", nullptr, &show_viewport_config_);
+            ImGui::MenuItem("Stats", nullptr, &show_stats_);
             ImGui::EndMenu();
         }
         ImGui::EndMenuBar();
@@ -289,7 +319,7 @@ void EditorUi::Draw(ImTextureID texture_id, int fb_width, int fb_height, int win
             ImVec2 avail = ImGui::GetContentRegionAvail();
             ImVec2 image_pos{};
             ImVec2 image_size{};
-            DrawViewportImage(texture_id, fb_width, fb_height, &image_pos, &image_size);
+            DrawViewportImage(texture_id, uv_extent, fb_width, fb_height, &image_pos, &image_size);
 
             if (show_fps_overlay_) {
                 ImGuiIO& io = ImGui::GetIO();
@@ -330,6 +360,7 @@ void EditorUi::Draw(ImTextureID texture_id, int fb_width, int fb_height, int win
                 viewport_has_mouse_ = true;
                 viewport_mouse_x_ = px;
                 viewport_mouse_y_ = fb_height - 1 - py;
+                DrawPixelCursor(image_pos, image_size, fb_width, fb_height, px, py);
             }
         }
         ImGui::End();
@@ -407,6 +438,38 @@ void EditorUi::Draw(ImTextureID texture_id, int fb_width, int fb_height, int win
             viewport_target_width_ = std::max(1, viewport_target_width_);
             viewport_target_height_ = std::max(1, viewport_target_height_);
             ImGui::Text("Active: %d x %d", viewport_target_width_, viewport_target_height_);
+            ImGui::Checkbox("Multithreaded (Tile-Binned)", &binned_renderer_);
+            const char* antialiasing[] = {"Off", "2x2 SSAA", "4x4 SSAA"};
+            ImGui::Combo("Anti-aliasing", &antialiasing_index_, antialiasing, 3);
+            const bool supersampled = antialiasing_index_ > 0;
+            if (!binned_renderer_) {
+                ImGui::Checkbox("Tiled Framebuffer", &tiled_framebuffer_);
+            }
+            // The supersampled resolve only writes RGBA8.
+            if (!binned_renderer_ && !supersampled) {
+                // Palette8 needs the GL presenter's palette pass.
+                const char* formats[] = {"RGBA8", "BGRA8", "RGB565", "Palette8 (RGB332)"};
+#if defined(SANDBOX_D3D11)
+                const int format_count = 3;
+#else
+                const int format_count = 4;
+#endif
+                int format_index = static_cast<int>(output_format_);
+                if (ImGui::Combo("Pixel Format", &format_index, formats, format_count)) {
+                    output_format_ = static_cast<PixelFormat>(format_index);
+                }
+                ImGui::Checkbox("Overdraw Heatmap", &overdraw_view_);
+                if (overdraw_view_) {
+                    const double ratio =
+                        overdraw_covered_ > 0
+                            ? static_cast<double>(overdraw_writes_) / overdraw_covered_
+                            : 0.0;
+                    ImGui::Text("Writes: %llu", static_cast<unsigned long long>(overdraw_writes_));
+                    ImGui::Text("Clipped: %llu",
+                                static_cast<unsigned long long>(overdraw_clipped_));
+                    ImGui::Text("Overdraw: %.2fx", ratio);
+                }
+            }
             ImGui::Separator();
 
             ImGui::Text("Window: %d x %d", win_width, win_height);
@@ -414,6 +477,13 @@ void EditorUi::Draw(ImTextureID texture_id, int fb_width, int fb_height, int win
             float scale_x = win_width > 0 ? static_cast<float>(fb_width) / win_width : 0.0f;
             float scale_y = win_height > 0 ? static_cast<float>(fb_height) / win_height : 0.0f;
             ImGui::Text("DPI Scale: %.2f x %.2f", scale_x, scale_y);
+            ImGui::Text("Upload: %.3f ms (%.1f KB)", upload_ms_, upload_bytes_ / 1024.0);
+#if !defined(SANDBOX_D3D11)
+            ImGui::Checkbox("Streamed Upload (PBO)", &streamed_upload_);
+            if (!binned_renderer_ && !supersampled) {
+                ImGui::Checkbox("Zero-Copy Target", &zero_copy_target_);
+            }
+#endif
             ImGui::ColorEdit4("##clear", clear_color_, ImGuiColorEditFlags_AlphaBar);
             ImGui::Checkbox("FPS Overlay", &show_fps_overlay_);
             ImGui::Separator();
@@ -423,6 +493,47 @@ void EditorUi::Draw(ImTextureID texture_id, int fb_width, int fb_height, int win
         }
         ImGui::End();
     }
+
+    if (show_stats_) {
+        if (ImGui::Begin("Stats", &show_stats_)) {
+            // The history fills from slot 0, so it only wraps once it is full.
+            const int oldest = stats_count_ < kStatsHistory ? 0 : stats_next_;
+            const int newest = (stats_next_ + kStatsHistory - 1) % kStatsHistory;
+            RenderStats total;
+            float total_ms = 0.0f;
+            float max_ms = 0.0f;
+            for (int i = 0; i < stats_count_; ++i) {
+                total += stats_history_[i];
+                total_ms += frame_ms_history_[i];
+                max_ms = std::max(max_ms, frame_ms_history_[i]);
+            }
+            const RenderStats& last = stats_history_[newest];
+            const double frames = std::max(stats_count_, 1);
+            ImGui::Text("Frame: %.2f ms (avg %.2f, max %.2f)", frame_ms_history_[newest],
+                        total_ms / frames, max_ms);
+            ImGui::PlotLines("##frame_ms", frame_ms_history_, stats_count_, oldest, nullptr, 0.0f,
+                             FLT_MAX, ImVec2(0.0f, 48.0f));
+            ImGui::Text("Averages over the last %d frames", stats_count_);
+            ImGui::Separator();
+            if (kRenderStats) {
+                StatRow("Pixels written", last.pixels_written, total.pixels_written / frames);
+                StatRow("Pixels rejected", last.pixels_rejected, total.pixels_rejected / frames);
+                StatRow("Spans filled", last.spans_filled, total.spans_filled / frames);
+                StatRow("Lines drawn", last.lines_drawn, total.lines_drawn / frames);
+            } else {
+                ImGui::TextDisabled("Renderer counters are compiled out of this build.");
+            }
+            StatRow("Bytes uploaded", last.bytes_uploaded, total.bytes_uploaded / frames);
+        }
+        ImGui::End();
+    }
+}
+
+void EditorUi::AddFrameStats(float frame_ms, const RenderStats& stats) {
+    frame_ms_history_[stats_next_] = frame_ms;
+    stats_history_[stats_next_] = stats;
+    stats_next_ = (stats_next_ + 1) % kStatsHistory;
+    stats_count_ = std::min(stats_count_ + 1, kStatsHistory);
 }
 
 bool EditorUi::ConsumeStepRequested() {
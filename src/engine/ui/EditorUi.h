@@ -1,5 +1,10 @@
 #pragma once
 
+#include "engine/core/PixelFormat.h"
+#include "engine/core/RenderStats.h"
+
+#include <cstddef>
+#include <cstdint>
 #include <imgui.h>
 
 class EditorUi {
@@ -10,8 +15,8 @@ class EditorUi {
         Paused,
     };
 
-    void Draw(ImTextureID texture_id, int fb_width, int fb_height, int win_width, int win_height,
-              class SceneManager& scenes);
+    void Draw(ImTextureID texture_id, ImVec2 uv_extent, int fb_width, int fb_height, int win_width,
+              int win_height, class SceneManager& scenes);
     const float* ClearColor() const { return clear_color_; }
     bool GetViewportMousePixel(int* out_x, int* out_y) const;
     bool IsViewportHovered() const { return viewport_has_mouse_; }
@@ -22,6 +27,25 @@ class EditorUi {
     bool ConsumeStopRequested();
     bool VsyncEnabled() const { return vsync_enabled_; }
     bool ShowFpsOverlay() const { return show_fps_overlay_; }
+    bool TiledFramebuffer() const { return tiled_framebuffer_; }
+    bool UseBinnedRenderer() const { return binned_renderer_; }
+    PixelFormat OutputFormat() const { return output_format_; }
+    // Samples per pixel along each axis; 1 renders without supersampling.
+    int SupersampleFactor() const { return 1 << antialiasing_index_; }
+    bool StreamedUpload() const { return streamed_upload_; }
+    bool ZeroCopyTarget() const { return zero_copy_target_; }
+    void SetUploadStats(float ms, size_t bytes) {
+        upload_ms_ = ms;
+        upload_bytes_ = bytes;
+    }
+    bool OverdrawView() const { return overdraw_view_; }
+    void SetOverdrawStats(uint64_t writes, uint64_t clipped, uint64_t covered) {
+        overdraw_writes_ = writes;
+        overdraw_clipped_ = clipped;
+        overdraw_covered_ = covered;
+    }
+    // Adds a frame to the Stats panel's history: its duration and what the renderer did in it.
+    void AddFrameStats(float frame_ms, const RenderStats& stats);
     void SetFocusViewport(bool enabled) { focus_viewport_ = enabled; }
 
   private:
@@ -30,6 +54,18 @@ class EditorUi {
     float clear_color_[4] = {0.0f, 0.0f, 0.0f, 1.0f};
     bool vsync_enabled_ = true;
     bool show_fps_overlay_ = true;
+    bool tiled_framebuffer_ = false;
+    bool binned_renderer_ = false;
+    PixelFormat output_format_ = PixelFormat::RGBA8;
+    int antialiasing_index_ = 0;
+    bool streamed_upload_ = true;
+    bool zero_copy_target_ = true;
+    float upload_ms_ = 0.0f;
+    size_t upload_bytes_ = 0;
+    bool overdraw_view_ = false;
+    uint64_t overdraw_writes_ = 0;
+    uint64_t overdraw_clipped_ = 0;
+    uint64_t overdraw_covered_ = 0;
     PlayState play_state_ = PlayState::Playing;
     bool step_requested_ = false;
     bool stop_requested_ = false;
@@ -38,6 +74,13 @@ class EditorUi {
     bool show_viewport_ = true;
     bool show_log_ = true;
     bool show_viewport_config_ = true;
+    bool show_stats_ = true;
+    // Ring of the last kStatsHistory frames; stats_next_ is the slot the next frame goes in.
+    static constexpr int kStatsHistory = 120;
+    float frame_ms_history_[kStatsHistory] = {};
+    RenderStats stats_history_[kStatsHistory] = {};
+    int stats_next_ = 0;
+    int stats_count_ = 0;
     bool request_show_scene_ = false;
     bool viewport_has_mouse_ = false;
     int viewport_mouse_x_ = 0;